@@ -0,0 +1,120 @@
+#pragma once
+
+// eosiolib (eosiocpp) 와 eosio.cdt (eosio-cpp) 를 하나의 소스로 빌드하기 위한 호환 계층
+//
+//   eosiolib  : make eosiolib (eosiocpp -o devtooth_nft.wast, eosiocpp -g devtooth_nft.abi)
+//   eosio.cdt : make cdt      (eosio-cpp -abigen -o devtooth_nft.wasm)
+//
+// 컨트랙트 코드는 아래 이름만 사용한다.
+//   account_type, sym_type            계정 / 심볼 타입
+//   N(x), S(0, x), same_payer         이름, 심볼 상수, modify 시 기존 payer 유지
+//   scope_of(), sym_code(), to_symbol(), content_digest(), content_key()
+//   CONTRACT, ACTION, TABLE, DEVTOOTH_DISPATCH, DEVTOOTH_DISPATCH_TRANSFER
+
+#include <eosiolib/eosio.hpp>
+#include <eosiolib/asset.hpp>
+#include <eosiolib/singleton.hpp>
+#include <eosiolib/crypto.h>
+#include <eosiolib/db.h>
+#include <algorithm>
+#include <string>
+#include <tuple>
+
+// eosio.cdt 의 dispatcher 만 EOSIO_DISPATCH 를 정의한다
+#ifdef EOSIO_DISPATCH
+#define DEVTOOTH_EOSIO_CDT 1
+#endif
+
+#ifdef DEVTOOTH_EOSIO_CDT
+
+#ifndef N
+#define DEVTOOTH_NAME_LITERAL(STR) STR##_n
+#define N(X) DEVTOOTH_NAME_LITERAL(#X)
+#endif
+
+#ifndef S
+#define S(P, X) ::eosio::symbol(#X, P)
+#endif
+
+#define DEVTOOTH_DISPATCH EOSIO_DISPATCH
+
+// 자기 action 에 더해 eosio.token transfer 알림을 HANDLER 로 전달
+#define DEVTOOTH_DISPATCH_TRANSFER( TYPE, MEMBERS, HANDLER ) \
+extern "C" { \
+    void apply( uint64_t receiver, uint64_t code, uint64_t action ) { \
+        if( code == receiver ) { \
+            switch( action ) { \
+                EOSIO_DISPATCH_HELPER( TYPE, MEMBERS ) \
+            } \
+        } else if( ::eosio::name(code) == N(eosio.token) && ::eosio::name(action) == N(transfer) ) { \
+            ::eosio::execute_action( ::eosio::name(receiver), ::eosio::name(code), &TYPE::HANDLER ); \
+        } \
+    } \
+}
+
+namespace eosio {
+    typedef name account_type;
+    typedef symbol sym_type;
+    typedef capi_checksum256 hash_type;
+
+    inline uint64_t scope_of( account_type account ) { return account.value; }
+    inline uint64_t sym_code( sym_type sym ) { return sym.code().raw(); }
+    inline sym_type to_symbol( const std::string& sym ) { return sym_type( symbol_code( sym ), 0 ); }
+}
+
+#else
+
+#define CONTRACT class
+#define ACTION void
+#define TABLE struct
+
+#define DEVTOOTH_DISPATCH EOSIO_ABI
+
+// 자기 action 에 더해 eosio.token transfer 알림을 HANDLER 로 전달
+#define DEVTOOTH_DISPATCH_TRANSFER( TYPE, MEMBERS, HANDLER ) \
+extern "C" { \
+    void apply( uint64_t receiver, uint64_t code, uint64_t action ) { \
+        TYPE thiscontract( receiver ); \
+        if( code == receiver ) { \
+            switch( action ) { \
+                EOSIO_API( TYPE, MEMBERS ) \
+            } \
+        } else if( code == N(eosio.token) && action == N(transfer) ) { \
+            ::eosio::execute_action( &thiscontract, &TYPE::HANDLER ); \
+        } \
+    } \
+}
+
+namespace eosio {
+    typedef account_name account_type;
+    typedef symbol_type sym_type;
+    typedef checksum256 hash_type;
+
+    static const account_type same_payer = 0;
+
+    inline uint64_t scope_of( account_type account ) { return account; }
+    inline uint64_t sym_code( sym_type sym ) { return sym.name(); }
+    inline sym_type to_symbol( const std::string& sym ) { return sym_type( string_to_symbol( 0, sym.c_str() ) ); }
+}
+
+#endif
+
+namespace eosio {
+    // 직렬화된 데이터의 sha256
+    inline hash_type content_digest( const std::vector<char>& data ) {
+        hash_type hash;
+        sha256( data.data(), data.size(), &hash );
+        return hash;
+    }
+
+    // 직렬화된 데이터의 sha256 앞 8 byte, 내용 기반 primary key 로 사용
+    inline uint64_t content_key( const std::vector<char>& data ) {
+        hash_type hash = content_digest( data );
+
+        uint64_t key = 0;
+        for( int i = 0; i < 8; ++i ) {
+            key = (key << 8) | hash.hash[i];
+        }
+        return key;
+    }
+}
@@ -4,148 +4,156 @@ namespace eosio {
     using std::string;
     using eosio::asset;
 
-    void devtooth_nft::create( account_name issuer, string sym ) {
+    ACTION devtooth_nft::create( account_type issuer, string sym ) {
 	    require_auth( _self );
 
 	    // Check if issuer account exists
 	    eosio_assert( is_account( issuer ), "issuer account does not exist");
 
         // Valid symbol
-        asset supply(0, string_to_symbol(0, sym.c_str()));
+        asset supply(0, to_symbol(sym));
 
         auto symbol = supply.symbol;
         eosio_assert( symbol.is_valid(), "invalid symbol name" );
         eosio_assert( supply.is_valid(), "invalid supply");
 
         // Check if currency with symbol already exists
-        currency_index currency_table( _self, symbol.name() );
-        auto existing_currency = currency_table.find( symbol.name() );
-        eosio_assert( existing_currency == currency_table.end(), "token with symbol already exists" );
+        uint8_t kind = kind_of( symbol );
+        stats_table stats( _self, scope_of(_self) );
+        auto st = stats.get_or_default( token_stats{} );
+        st.kinds.resize( kind_count );
+        eosio_assert( st.kinds[kind].issuer == account_type(), "token with symbol already exists" );
 
         // Create new currency
-        currency_table.emplace( _self, [&]( auto& currency ) {
-           currency.supply = supply;
-           currency.issuer = issuer;
-        });
+        st.kinds[kind].supply = supply;
+        st.kinds[kind].issuer = issuer;
+        stats.set( st, _self );
     }
 
-    void devtooth_nft::issue(account_name to, asset quantity, uint64_t index)
+    ACTION devtooth_nft::issue(account_type to, asset quantity, uint64_t index)
     {
 	    eosio_assert( is_account( to ), "to account does not exist");
 
         // e,g, Get EOS from 3 EOS
-        symbol_type symbol = quantity.symbol;
-        eosio_assert( symbol.is_valid(), "invalid symbol name" );
-        eosio_assert( symbol.precision() == 0, "quantity must be a whole number" );
+        auto symbols = quantity.symbol;
+        eosio_assert( symbols.is_valid(), "invalid symbol name" );
+        eosio_assert( symbols.precision() == 0, "quantity must be a whole number" );
 
-        // Ensure currency has been created
-        auto symbol_name = symbol.name();
-        currency_index currency_table( _self, symbol_name );
-        auto existing_currency = currency_table.find( symbol_name );
-        eosio_assert( existing_currency != currency_table.end(), "token with symbol does not exist. create token before issue" );
-        const auto& st = *existing_currency;
+        // Ensure currency has been created, supply 와 issuer 는 한 번만 읽음
+        uint8_t kind = kind_of( symbols );
+        stats_table stats( _self, scope_of(_self) );
+        auto st = stats.get_or_default( token_stats{} );
+        eosio_assert( kind < st.kinds.size() && st.kinds[kind].issuer != account_type(), "token with symbol does not exist. create token before issue" );
+        auto& current = st.kinds[kind];
 
         // Ensure have issuer authorization and valid quantity
-        //require_auth( to );
+        require_auth( current.issuer );
         require_auth(to);
+        check_shard( kind, to );
         eosio_assert( quantity.is_valid(), "invalid quantity" );
         eosio_assert( quantity.amount > 0, "must issue positive quantity of uts" );
-        eosio_assert( symbol == st.supply.symbol, "symbol precision mismatch" );
+        eosio_assert( symbols == current.supply.symbol, "symbol precision mismatch" );
+
+        id_type id = reserve_ids( 1 );
 
         // Case UTS
-        if( symbol == S(0, UTS)){
+        if( kind == servant_kind ){
             // Get Servant info
-            servant_table servant(N(unlimittest1), to);
+            servant_table servant(N(unlimittest1), scope_of(to));
             auto servant_iter = servant.get(index, "Not exist Servant");
 
             // Check Token duplication
-            auto uts_list = s_tokens.get_index<N(byowner)>();
-            bool not_exist = true;
-            for(auto it = uts_list.begin(); it != uts_list.end(); ++it){
-                if(it->t_idx == servant_iter.index){
-                    not_exist = false;
-                    break;
-                }
-            }
-            eosio_assert(not_exist, "Already exist Token");
+            auto uts_list = s_tokens.get_index<N(bymaster)>();
+            eosio_assert(uts_list.find(master_key(to, servant_iter.index)) == uts_list.end(), "Already exist Token");
+
+            uint64_t template_id = acquire_template( attrs_of(servant_iter), to );
 
              // Add token with creator paying for RAM
             s_tokens.emplace( to, [&]( auto& token ) {
-                token.idx = s_tokens.available_primary_key();
+                token.idx = id;
                 token.t_idx = index;
                 token.state = "idle";
 
                 token.owner = to;
                 token.master = to;
-                token.value = asset{1, symbol};
+                token.value = asset{1, symbols};
+                token.stats = stats_of(servant_iter);
+                token.template_id = template_id;
             });
         }
         // Case UTM
-        if( symbol == S(0, UTM)){
+        if( kind == monster_kind ){
             // Get Monster info
-            monster_table monster(N(unlimittest1), to);
+            monster_table monster(N(unlimittest1), scope_of(to));
             auto monster_iter = monster.get(index, "Not exist Monster");
 
             // Check Token duplication
-            auto utm_list = m_tokens.get_index<N(byowner)>();
-            bool not_exist = true;
-            for(auto it = utm_list.begin(); it != utm_list.end(); ++it){
-                if(it->t_idx == monster_iter.index){
-                    not_exist = false;
-                    break;
-                }
-            }
-            eosio_assert(not_exist, "Already exist Token");
+            auto utm_list = m_tokens.get_index<N(bymaster)>();
+            eosio_assert(utm_list.find(master_key(to, monster_iter.index)) == utm_list.end(), "Already exist Token");
+
+            uint64_t template_id = acquire_template( attrs_of(monster_iter), to );
 
              // Add token with creator paying for RAM
             m_tokens.emplace( to, [&]( auto& token ) {
-                token.idx = m_tokens.available_primary_key();
+                token.idx = id;
                 token.t_idx = index;
                 token.state = "idle";
 
                 token.owner = to;
                 token.master = to;
-                token.value = asset{1, symbol};
+                token.value = asset{1, symbols};
+                token.stats = stats_of(monster_iter);
+                token.template_id = template_id;
             });
         }
         // Case UTI
-        if( symbol == S(0, UTI)){
+        if( kind == item_kind ){
             // Get Item info
-            item_table item(N(unlimittest1), to);
+            item_table item(N(unlimittest1), scope_of(to));
             auto item_iter = item.get(index, "Not exist Item");
 
             // Check Token duplication
-            auto uti_list = i_tokens.get_index<N(byowner)>();
-            bool not_exist = true;
-            for(auto it = uti_list.begin(); it != uti_list.end(); ++it){
-                if(it->t_idx == item_iter.index){
-                    not_exist = false;
-                    break;
-                }
-            }
-            eosio_assert(not_exist, "Already exist Token");
+            auto uti_list = i_tokens.get_index<N(bymaster)>();
+            eosio_assert(uti_list.find(master_key(to, item_iter.index)) == uti_list.end(), "Already exist Token");
+
+            uint64_t template_id = acquire_template( attrs_of(item_iter), to );
 
              // Add token with creator paying for RAM
             i_tokens.emplace( to, [&]( auto& token ) {
-                token.idx = i_tokens.available_primary_key();
+                token.idx = id;
                 token.t_idx = index;
                 token.state = "idle";
 
                 token.owner = to;
                 token.master = to;
-                token.value = asset{1, symbol};
+                token.value = asset{1, symbols};
+                token.stats = stats_of(item_iter);
+                token.template_id = template_id;
             });
         }
 
         // Increase supply
-	    add_supply( quantity );
+        current.supply += quantity;
+        stats.set( st, _self );
 
         // Add balance to account
         add_balance( to, quantity, to );
+        add_inventory( to, kind, { id } );
+        record_owner( id, to, to );
+
+        merkle_update( kind, id );
+        emit_event( event_issue, kind, _self, to, { id } );
+    }
+
+    ACTION devtooth_nft::transferid( account_type from, account_type to, id_type id, string sym)
+    {
+        transferk( from, to, id, kind_of( to_symbol(sym) ) );
     }
 
-    void devtooth_nft::transferid( account_name from, account_name to, id_type id, string sym)
+    ACTION devtooth_nft::transferk( account_type from, account_type to, id_type id, uint8_t kind )
     {
+        eosio_assert( kind < kind_count, "invalid token kind" );
+
         // Ensure authorized to send from account
         eosio_assert( from != to, "cannot transfer to self" );
         require_auth( from );
@@ -153,14 +161,16 @@ namespace eosio {
         // Ensure 'to' account exists
         eosio_assert( is_account( to ), "to account does not exist");
 
-        asset token(0, string_to_symbol(0, sym.c_str()));
+        // 만료된 대여/잠금은 접근 시점에 해제
+        expire_lease( id );
 
         // UTS
-        if( token.symbol == S(0, UTS) ){
+        if( kind == servant_kind ){
             auto sender_token = s_tokens.find( id );
             eosio_assert( sender_token != s_tokens.end(), "token with specified ID does not exist" );
             eosio_assert( sender_token->owner == from, "sender does not own token with specified ID");
             eosio_assert( sender_token->state == "idle", "a non-tradeable token");
+            eosio_assert( !sender_token->has_equipment(), "unequip items before transfer" );
 
             const auto& st = *sender_token;
 
@@ -170,9 +180,10 @@ namespace eosio {
 
             sub_balance( from, st.value );
             add_balance( to, st.value, from );
+            record_owner( id, to, from );
         }
         // UTM
-        if( token.symbol == S(0, UTM) ){
+        if( kind == monster_kind ){
             auto sender_token = m_tokens.find( id );
             eosio_assert( sender_token != m_tokens.end(), "token with specified ID does not exist" );
             eosio_assert( sender_token->owner == from, "sender does not own token with specified ID");
@@ -186,9 +197,10 @@ namespace eosio {
 
             sub_balance( from, st.value );
             add_balance( to, st.value, from );
+            record_owner( id, to, from );
         }
         // UTI
-        if( token.symbol == S(0, UTI) ){
+        if( kind == item_kind ){
             auto sender_token = i_tokens.find( id );
             eosio_assert( sender_token != i_tokens.end(), "token with specified ID does not exist" );
             eosio_assert( sender_token->owner == from, "sender does not own token with specified ID");
@@ -202,27 +214,44 @@ namespace eosio {
 
             sub_balance( from, st.value );
             add_balance( to, st.value, from );
+            record_owner( id, to, from );
         }
 
+        sub_inventory( from, kind, id );
+        add_inventory( to, kind, { id } );
+
+        merkle_update( kind, id );
+        emit_event( event_transfer, kind, from, to, { id } );
+
 	    // Notify both recipients
         require_recipient( from );
         require_recipient( to );
     }
 
-    void devtooth_nft::changestate(account_name from, string sym, id_type id){
+    ACTION devtooth_nft::changestate(account_type from, string sym, id_type id){
+        changestatek( from, kind_of( to_symbol(sym) ), id );
+    }
+
+    ACTION devtooth_nft::changestatek(account_type from, uint8_t kind, id_type id){
         require_auth(from);
+        eosio_assert( kind < kind_count, "invalid token kind" );
+
+        // 만료된 대여/잠금은 접근 시점에 해제
+        expire_lease( id );
 
-        asset token(0, string_to_symbol(0, sym.c_str()));
+        uint8_t type = event_unlist;
 
         // UTS
-        if( token.symbol == S(0, UTS) ){
+        if( kind == servant_kind ){
             auto target_token = s_tokens.find( id );
             eosio_assert( target_token != s_tokens.end(), "token with specified ID does not exist" );
             eosio_assert( target_token->owner == from, "sender does not own token with specified ID");
 
             const auto& st = *target_token;
+            eosio_assert( st.state == "idle" || st.state == "selling", "token is rented or locked" );
 
             if(st.state == "idle"){
+                type = event_list;
                 s_tokens.modify( st, from, [&]( auto& token ) {
 	            token.state = "selling";
                 });
@@ -234,14 +263,16 @@ namespace eosio {
             }
         }
         // UTM
-        if( token.symbol == S(0, UTM) ){
+        if( kind == monster_kind ){
             auto target_token = m_tokens.find( id );
             eosio_assert( target_token != m_tokens.end(), "token with specified ID does not exist" );
             eosio_assert( target_token->owner == from, "sender does not own token with specified ID");
 
             const auto& st = *target_token;
+            eosio_assert( st.state == "idle" || st.state == "selling", "token is rented or locked" );
 
             if(st.state == "idle"){
+                type = event_list;
                 m_tokens.modify( st, from, [&]( auto& token ) {
 	            token.state = "selling";
                 });
@@ -253,14 +284,16 @@ namespace eosio {
             }
         }
         // UTI
-        if( token.symbol == S(0, UTI) ){
+        if( kind == item_kind ){
             auto target_token = i_tokens.find( id );
             eosio_assert( target_token != i_tokens.end(), "token with specified ID does not exist" );
             eosio_assert( target_token->owner == from, "sender does not own token with specified ID");
 
             const auto& st = *target_token;
+            eosio_assert( st.state == "idle" || st.state == "selling", "token is rented or locked" );
 
             if(st.state == "idle"){
+                type = event_list;
                 i_tokens.modify( st, from, [&]( auto& token ) {
 	            token.state = "selling";
                 });
@@ -271,120 +304,1825 @@ namespace eosio {
                 });
             }
         }
+
+        merkle_update( kind, id );
+        emit_event( type, kind, from, from, { id } );
+    }
+
+    ACTION devtooth_nft::backtogame(account_type from, string sym, id_type id){
+        backtogamek( from, kind_of( to_symbol(sym) ), id );
     }
 
-    void devtooth_nft::backtogame(account_name from, string sym, id_type id){
+    ACTION devtooth_nft::backtogamek(account_type from, uint8_t kind, id_type id){
         require_auth(from);
+        eosio_assert( kind < kind_count, "invalid token kind" );
 
-        asset token(0, string_to_symbol(0, sym.c_str()));
+        // 만료된 대여/잠금은 접근 시점에 해제
+        expire_lease( id );
 
         // UTS
-        if( token.symbol == S(0, UTS) ){
+        if( kind == servant_kind ){
             auto target_token = s_tokens.find( id );
             eosio_assert( target_token != s_tokens.end(), "token with specified ID does not exist" );
             eosio_assert( target_token->owner == from, "sender does not own token with specified ID");
             eosio_assert( target_token->state == "idle", "Can not back to game in auction");
+            eosio_assert( !target_token->has_equipment(), "unequip items before back to game" );
 
-            const auto& st = *target_token;
+            auto value = target_token->value;
+            release_template( target_token->template_id );
+            s_tokens.erase( target_token );
+            erase_history( id );
 
-            s_tokens.erase( st ); 
+            sub_balance( from, value );
+            sub_supply( value );
         }
         // UTM
-        if( token.symbol == S(0, UTM) ){
+        if( kind == monster_kind ){
             auto target_token = m_tokens.find( id );
             eosio_assert( target_token != m_tokens.end(), "token with specified ID does not exist" );
             eosio_assert( target_token->owner == from, "sender does not own token with specified ID");
             eosio_assert( target_token->state == "idle", "Can not back to game in auction");
 
-            const auto& st = *target_token;
+            auto value = target_token->value;
+            release_template( target_token->template_id );
+            m_tokens.erase( target_token );
+            erase_history( id );
 
-            m_tokens.erase( st ); 
+            sub_balance( from, value );
+            sub_supply( value );
         }
         // UTI
-        if( token.symbol == S(0, UTI) ){
+        if( kind == item_kind ){
             auto target_token = i_tokens.find( id );
             eosio_assert( target_token != i_tokens.end(), "token with specified ID does not exist" );
             eosio_assert( target_token->owner == from, "sender does not own token with specified ID");
             eosio_assert( target_token->state == "idle", "Can not back to game in auction");
 
-            const auto& st = *target_token;
+            auto value = target_token->value;
+            release_template( target_token->template_id );
+            i_tokens.erase( target_token );
+            erase_history( id );
 
-            i_tokens.erase( st ); 
+            sub_balance( from, value );
+            sub_supply( value );
         }
+
+        sub_inventory( from, kind, id );
+
+        merkle_update( kind, id );
+        emit_event( event_burn, kind, from, _self, { id } );
     }
 
-    void devtooth_nft::clean() {
-        for(auto iter = s_tokens.begin(); iter != s_tokens.end();){
-            auto token_iter = s_tokens.find(iter->primary_key());
-            iter++;
-            s_tokens.erase(token_iter);
+    ACTION devtooth_nft::clean() {
+        require_auth( _self );
+
+        // 이전 레이아웃의 행도 지울 수 있도록 purge 와 같은 경로로 지우고, 잔액과 supply 도 되돌림
+        // Merkle 트리는 아래에서 통째로 지움
+        for( uint8_t kind = 0; kind < kind_count; ++kind ) {
+            purge_tokens( kind, uint32_t(-1), false );
+        }
+
+        history_index history( _self, scope_of(_self) );
+        for(auto iter4 = history.begin(); iter4 != history.end(); ){
+            iter4 = history.erase(iter4);
+        }
+
+        lease_index leases( _self, scope_of(_self) );
+        for(auto iter5 = leases.begin(); iter5 != leases.end(); ){
+            iter5 = leases.erase(iter5);
+        }
+
+        inventory_index inventories( _self, scope_of(_self) );
+        for(auto iter6 = inventories.begin(); iter6 != inventories.end(); ){
+            iter6 = inventories.erase(iter6);
+        }
+
+        template_index templates( _self, scope_of(_self) );
+        for(auto iter7 = templates.begin(); iter7 != templates.end(); ){
+            iter7 = templates.erase(iter7);
+        }
+
+        // 예치금(funds)은 유저 자산이므로 지우지 않고, 최고 입찰액은 입찰자에게 돌려준 뒤 경매를 지움
+        auction_index auctions( _self, scope_of(_self) );
+        for(auto iter8 = auctions.begin(); iter8 != auctions.end(); ){
+            if( iter8->bidder != account_type() && iter8->high_bid.amount > 0 ) {
+                add_fund( iter8->bidder, iter8->high_bid );
+            }
+            iter8 = auctions.erase(iter8);
+        }
+
+        migration_index exports( _self, scope_of(N(export)) );
+        for(auto iter9 = exports.begin(); iter9 != exports.end(); ){
+            iter9 = exports.erase(iter9);
         }
 
-        for(auto iter2 = m_tokens.begin(); iter2 != m_tokens.end();){
-            auto token_iter2 = m_tokens.find(iter2->primary_key());
-            iter2++;
-            m_tokens.erase(token_iter2);
+        migration_index imports( _self, scope_of(N(import)) );
+        for(auto iter10 = imports.begin(); iter10 != imports.end(); ){
+            iter10 = imports.erase(iter10);
         }
 
-        for(auto iter3 = i_tokens.begin(); iter3 != i_tokens.end(); ){
-            auto token_iter3 = i_tokens.find(iter3->primary_key());
-            iter3++;
-            i_tokens.erase(token_iter3);
+        merkle_table merkle( _self, scope_of(_self) );
+        auto m = merkle.get_or_default( merkle_info{} );
+        for( uint8_t level = 1; level <= m.height; ++level ) {
+            merkle_node_index nodes( _self, level );
+            for(auto iter11 = nodes.begin(); iter11 != nodes.end(); ){
+                iter11 = nodes.erase(iter11);
+            }
+        }
+        merkle_leaf_index leaves( _self, scope_of(_self) );
+        for(auto iter12 = leaves.begin(); iter12 != leaves.end(); ){
+            iter12 = leaves.erase(iter12);
         }
+        merkle.remove();
     }
 
-    void devtooth_nft::sub_balance( account_name owner, asset value ) 
+    ACTION devtooth_nft::sethistory( uint8_t depth )
     {
-        account_index from_acnts( _self, owner );
-        const auto& from = from_acnts.get( value.symbol.name(), "no balance object found" );
-        eosio_assert( from.balance.amount >= value.amount, "overdrawn balance" );
+        require_auth( _self );
+
+        config_table configs( _self, scope_of(_self) );
+        auto config = configs.get_or_default( config_info{} );
+        config.history_depth = depth;
+        configs.set( config, _self );
+    }
 
+    void devtooth_nft::record_owner( id_type id, account_type owner, account_type ram_payer )
+    {
+        config_table configs( _self, scope_of(_self) );
+        uint8_t depth = configs.get_or_default( config_info{} ).history_depth;
+        if( depth == 0 ) {
+            return;
+        }
 
-        if( from.balance.amount == value.amount ) {
-            from_acnts.erase( from );
+        owner_record record{ owner, now() };
+
+        history_index history( _self, scope_of(_self) );
+        auto existing = history.find( id );
+        if( existing == history.end() ) {
+            history.emplace( ram_payer, [&]( auto& h ) {
+                h.idx = id;
+                h.records.resize( depth );
+                h.records[0] = record;
+                h.head = 1 % depth;
+            });
         } else {
-            from_acnts.modify( from, owner, [&]( auto& a ) {
-                a.balance -= value;
+            history.modify( existing, ram_payer, [&]( auto& h ) {
+                if( h.records.size() != depth ) {
+                    resize_history( h, depth );
+                }
+                h.records[h.head] = record;
+                h.head = (h.head + 1) % depth;
             });
         }
     }
 
-    void devtooth_nft::add_balance( account_name owner, asset value, account_name ram_payer )
+    void devtooth_nft::resize_history( token_history& h, uint8_t depth )
     {
-        account_index to_accounts( _self, owner );
-        auto to = to_accounts.find( value.symbol.name() );
-        if( to == to_accounts.end() ) {
-            to_accounts.emplace( ram_payer, [&]( auto& a ){
-                a.balance = value;
+        // 오래된 기록부터 순서대로 정렬한 뒤 최근 depth 개만 유지
+        std::vector<owner_record> ordered;
+        for( size_t i = 0; i < h.records.size(); ++i ) {
+            const auto& record = h.records[(h.head + i) % h.records.size()];
+            if( record.owner != account_type() ) {
+                ordered.push_back( record );
+            }
+        }
+        if( ordered.size() > depth ) {
+            ordered.erase( ordered.begin(), ordered.end() - depth );
+        }
+
+        h.head = ordered.size() % depth;
+        ordered.resize( depth );
+        h.records = ordered;
+    }
+
+    void devtooth_nft::erase_history( id_type id )
+    {
+        history_index history( _self, scope_of(_self) );
+        auto existing = history.find( id );
+        if( existing != history.end() ) {
+            history.erase( existing );
+        }
+    }
+
+    ACTION devtooth_nft::lend( account_type owner, account_type lessee, uint8_t kind, id_type id, uint32_t duration )
+    {
+        eosio_assert( kind < kind_count, "invalid token kind" );
+        eosio_assert( owner != lessee, "cannot lend to self" );
+        eosio_assert( is_account( lessee ), "lessee account does not exist");
+
+        start_lease( owner, lessee, kind, id, duration, "rented" );
+    }
+
+    ACTION devtooth_nft::lock( account_type owner, uint8_t kind, id_type id, uint32_t duration )
+    {
+        eosio_assert( kind < kind_count, "invalid token kind" );
+        start_lease( owner, owner, kind, id, duration, "locked" );
+    }
+
+    ACTION devtooth_nft::reclaim( uint32_t max_count )
+    {
+        lease_index leases( _self, scope_of(_self) );
+        auto by_expiry = leases.get_index<N(byexpiry)>();
+
+        // expire_lease 와 같은 lessee -> owner 형태로, (kind, lessee, owner) 별로 묶어서 이벤트 하나씩
+        std::vector<std::tuple<uint8_t, uint64_t, uint64_t, id_type>> released;
+        std::vector<std::pair<account_type, account_type>> parties;
+        uint32_t count = 0;
+        for( auto it = by_expiry.begin(); it != by_expiry.end() && count < max_count; ++count ) {
+            if( it->expiry > now() ) {
+                break;
+            }
+            restore_token( *it );
+            released.emplace_back( it->kind, scope_of(it->lessee), scope_of(it->owner), it->idx );
+            parties.emplace_back( it->lessee, it->owner );
+            it = by_expiry.erase( it );
+        }
+
+        std::vector<size_t> order( released.size() );
+        for( size_t i = 0; i < order.size(); ++i ) {
+            order[i] = i;
+        }
+        std::sort( order.begin(), order.end(), [&]( size_t a, size_t b ) { return released[a] < released[b]; } );
+
+        for( auto first = order.begin(); first != order.end(); ) {
+            const auto& key = released[*first];
+            std::vector<id_type> ids;
+            auto last = first;
+            for( ; last != order.end() && std::get<0>( released[*last] ) == std::get<0>( key )
+                    && std::get<1>( released[*last] ) == std::get<1>( key )
+                    && std::get<2>( released[*last] ) == std::get<2>( key ); ++last ) {
+                ids.push_back( std::get<3>( released[*last] ) );
+            }
+            emit_event( event_release, std::get<0>( key ), parties[*first].first, parties[*first].second, ids );
+            first = last;
+        }
+    }
+
+    ACTION devtooth_nft::equip( account_type owner, id_type servant_id, std::vector<id_type> item_ids )
+    {
+        require_auth( owner );
+        eosio_assert( item_ids.size() == servant_slot_count, "item_ids must cover every equip slot" );
+
+        expire_lease( servant_id );
+        auto servant = s_tokens.find( servant_id );
+        eosio_assert( servant != s_tokens.end(), "token with specified ID does not exist" );
+        eosio_assert( servant->owner == owner, "sender does not own token with specified ID");
+        eosio_assert( servant->state == "idle", "a non-tradeable token");
+
+        // 새 장비 목록에서 빠진 아이템은 idle 로 복귀
+        for( auto item_id : servant->equip_slot ) {
+            if( item_id == 0 || std::find( item_ids.begin(), item_ids.end(), item_id ) != item_ids.end() ) {
+                continue;
+            }
+            i_tokens.modify( i_tokens.get( item_id, "token with specified ID does not exist" ), same_payer, [&]( auto& token ) {
+                token.state = "idle";
+            });
+            merkle_update( item_kind, item_id );
+        }
+
+        // 새로 장착한 아이템은 equipped 로 거래 불가
+        bool empty = true;
+        for( auto i = item_ids.begin(); i != item_ids.end(); ++i ) {
+            if( *i == 0 ) {
+                continue;
+            }
+            empty = false;
+            eosio_assert( std::find( item_ids.begin(), i, *i ) == i, "item equipped twice" );
+            if( std::find( servant->equip_slot.begin(), servant->equip_slot.end(), *i ) != servant->equip_slot.end() ) {
+                continue;
+            }
+
+            expire_lease( *i );
+            auto item = i_tokens.find( *i );
+            eosio_assert( item != i_tokens.end(), "token with specified ID does not exist" );
+            eosio_assert( item->owner == owner, "sender does not own token with specified ID");
+            eosio_assert( item->state == "idle", "a non-tradeable token");
+
+            i_tokens.modify( item, owner, [&]( auto& token ) {
+                token.state = "equipped";
+            });
+            merkle_update( item_kind, *i );
+        }
+
+        s_tokens.modify( servant, owner, [&]( auto& token ) {
+            if( empty ) {
+                token.equip_slot.clear();
+            } else {
+                token.equip_slot = item_ids;
+            }
+        });
+
+        // 서번트 아이디 뒤에 슬롯 순서대로 아이템 아이디
+        std::vector<id_type> ids{ servant_id };
+        ids.insert( ids.end(), item_ids.begin(), item_ids.end() );
+        emit_event( event_equip, servant_kind, owner, owner, ids );
+    }
+
+    ACTION devtooth_nft::unequip( account_type owner, id_type servant_id )
+    {
+        equip( owner, servant_id, std::vector<id_type>( servant_slot_count, 0 ) );
+    }
+
+    void devtooth_nft::start_lease( account_type owner, account_type lessee, uint8_t kind, id_type id, uint32_t duration, string state )
+    {
+        require_auth( owner );
+        eosio_assert( duration > 0, "duration must be positive" );
+        eosio_assert( now() + duration > now(), "duration overflow" );
+
+        // 만료된 대여/잠금은 접근 시점에 해제
+        expire_lease( id );
+
+        // UTS
+        if( kind == servant_kind ){
+            auto target_token = s_tokens.find( id );
+            eosio_assert( target_token != s_tokens.end(), "token with specified ID does not exist" );
+            eosio_assert( target_token->owner == owner, "sender does not own token with specified ID");
+            eosio_assert( target_token->state == "idle", "a non-tradeable token");
+
+            s_tokens.modify( target_token, owner, [&]( auto& token ) {
+                token.state = state;
+            });
+        }
+        // UTM
+        if( kind == monster_kind ){
+            auto target_token = m_tokens.find( id );
+            eosio_assert( target_token != m_tokens.end(), "token with specified ID does not exist" );
+            eosio_assert( target_token->owner == owner, "sender does not own token with specified ID");
+            eosio_assert( target_token->state == "idle", "a non-tradeable token");
+
+            m_tokens.modify( target_token, owner, [&]( auto& token ) {
+                token.state = state;
+            });
+        }
+        // UTI
+        if( kind == item_kind ){
+            auto target_token = i_tokens.find( id );
+            eosio_assert( target_token != i_tokens.end(), "token with specified ID does not exist" );
+            eosio_assert( target_token->owner == owner, "sender does not own token with specified ID");
+            eosio_assert( target_token->state == "idle", "a non-tradeable token");
+
+            i_tokens.modify( target_token, owner, [&]( auto& token ) {
+                token.state = state;
+            });
+        }
+
+        lease_index leases( _self, scope_of(_self) );
+        leases.emplace( owner, [&]( auto& l ) {
+            l.idx = id;
+            l.kind = kind;
+            l.owner = owner;
+            l.lessee = lessee;
+            l.expiry = now() + duration;
+        });
+
+        merkle_update( kind, id );
+        emit_event( state == "rented" ? event_lend : event_lock, kind, owner, lessee, { id } );
+    }
+
+    void devtooth_nft::expire_lease( id_type id )
+    {
+        lease_index leases( _self, scope_of(_self) );
+        auto existing = leases.find( id );
+        if( existing == leases.end() || existing->expiry > now() ) {
+            return;
+        }
+
+        restore_token( *existing );
+        emit_event( event_release, existing->kind, existing->lessee, existing->owner, { id } );
+        leases.erase( existing );
+    }
+
+    void devtooth_nft::restore_token( const lease& l )
+    {
+        // UTS
+        if( l.kind == servant_kind ){
+            s_tokens.modify( s_tokens.get( l.idx, "token with specified ID does not exist" ), same_payer, [&]( auto& token ) {
+                token.state = "idle";
+            });
+        }
+        // UTM
+        if( l.kind == monster_kind ){
+            m_tokens.modify( m_tokens.get( l.idx, "token with specified ID does not exist" ), same_payer, [&]( auto& token ) {
+                token.state = "idle";
+            });
+        }
+        // UTI
+        if( l.kind == item_kind ){
+            i_tokens.modify( i_tokens.get( l.idx, "token with specified ID does not exist" ), same_payer, [&]( auto& token ) {
+                token.state = "idle";
             });
+        }
+
+        merkle_update( l.kind, l.idx );
+    }
+
+    ACTION devtooth_nft::migrate( account_type owner, uint8_t kind, uint64_t cursor, uint32_t budget )
+    {
+        require_auth( _self );
+        eosio_assert( kind < kind_count, "invalid token kind" );
+        eosio_assert( is_account( owner ), "owner account does not exist");
+        eosio_assert( budget > 0, "budget must be positive" );
+
+        // 토큰 가치의 심볼은 create 때 저장한 종류별 supply 에서 가져옴
+        stats_table stats( _self, scope_of(_self) );
+        auto st = stats.get_or_default( token_stats{} );
+        eosio_assert( kind < st.kinds.size() && st.kinds[kind].issuer != account_type(), "token with symbol does not exist. create token before issue" );
+        auto symbols = st.kinds[kind].supply.symbol;
+
+        check_shard( kind, owner );
+
+        // UTS
+        if( kind == servant_kind ){
+            servant_table servant(N(unlimittest1), scope_of(owner));
+            migrate_scope( s_tokens, servant, owner, symbols, cursor, budget );
+        }
+        // UTM
+        if( kind == monster_kind ){
+            monster_table monster(N(unlimittest1), scope_of(owner));
+            migrate_scope( m_tokens, monster, owner, symbols, cursor, budget );
+        }
+        // UTI
+        if( kind == item_kind ){
+            item_table item(N(unlimittest1), scope_of(owner));
+            migrate_scope( i_tokens, item, owner, symbols, cursor, budget );
+        }
+    }
+
+    template<typename TokenIndex, typename PreTable>
+    void devtooth_nft::migrate_scope( TokenIndex& tokens, const PreTable& rows, account_type owner, sym_type symbols, uint64_t cursor, uint32_t budget )
+    {
+        // cursor 부터 budget 개의 사전등록 행 중 아직 토큰이 없는 행만 수집
+        auto minted = tokens.template get_index<N(bymaster)>();
+        struct pending_row {
+            uint64_t index;
+            combat_stats stats;
+            template_attrs attrs;
+        };
+        std::vector<pending_row> pending;
+        auto row = rows.lower_bound( cursor );
+        for( uint32_t visited = 0; row != rows.end() && visited < budget; ++row, ++visited ) {
+            if( minted.find( master_key( owner, row->index ) ) == minted.end() ) {
+                pending.push_back( pending_row{ row->index, stats_of( *row ), attrs_of( *row ) } );
+            }
+        }
+
+        // 다음 호출에서 사용할 cursor
+        if( row == rows.end() ) {
+            print( "done" );
         } else {
-            to_accounts.modify( to, 0, [&]( auto& a ) {
-                a.balance += value;
+            print( "next ", row->index );
+        }
+
+        if( pending.empty() ) {
+            return;
+        }
+
+        // 아이디는 한 번에 예약하고 supply / balance 는 한 번만 갱신
+        id_type id = reserve_ids( pending.size() );
+        for( const auto& p : pending ) {
+            uint64_t template_id = acquire_template( p.attrs, _self );
+            tokens.emplace( _self, [&]( auto& token ) {
+                token.idx = id++;
+                token.t_idx = p.index;
+                token.state = "idle";
+
+                token.owner = owner;
+                token.master = owner;
+                token.value = asset{1, symbols};
+                token.stats = p.stats;
+                token.template_id = template_id;
+            });
+        }
+
+        asset quantity{ int64_t(pending.size()), symbols };
+        add_supply( quantity );
+        add_balance( owner, quantity, _self );
+
+        std::vector<id_type> ids;
+        for( id_type first = id - pending.size(); first < id; ++first ) {
+            ids.push_back( first );
+        }
+        add_inventory( owner, kind_of( symbols ), ids );
+        for( auto minted_id : ids ) {
+            record_owner( minted_id, owner, _self );
+            merkle_update( kind_of( symbols ), minted_id );
+        }
+        emit_event( event_issue, kind_of( symbols ), _self, owner, ids );
+    }
+
+    ACTION devtooth_nft::setstats( uint8_t kind, id_type id, status_info status, uint32_t atk, uint32_t def )
+    {
+        // 능력치 변경은 게임 컨트랙트만 반영
+        require_auth( N(unlimittest1) );
+        eosio_assert( kind < kind_count, "invalid token kind" );
+
+        auto stats = make_stats( status, atk, def );
+
+        // UTS
+        if( kind == servant_kind ){
+            s_tokens.modify( s_tokens.get( id, "token with specified ID does not exist" ), same_payer, [&]( auto& token ) {
+                token.stats = stats;
+            });
+        }
+        // UTM
+        if( kind == monster_kind ){
+            m_tokens.modify( m_tokens.get( id, "token with specified ID does not exist" ), same_payer, [&]( auto& token ) {
+                token.stats = stats;
+            });
+        }
+        // UTI
+        if( kind == item_kind ){
+            i_tokens.modify( i_tokens.get( id, "token with specified ID does not exist" ), same_payer, [&]( auto& token ) {
+                token.stats = stats;
             });
         }
+
+        emit_event( event_stats, kind, _self, _self, { id } );
+    }
+
+    ACTION devtooth_nft::syncstats( std::vector<stat_delta> deltas )
+    {
+        // 성장 수치 변경은 게임 컨트랙트만 반영, 값이 바뀐 토큰만 한 번씩 modify
+        require_auth( N(unlimittest1) );
+
+        std::vector<id_type> changed[kind_count];
+        for( const auto& delta : deltas ) {
+            eosio_assert( delta.kind < kind_count, "invalid token kind" );
+
+            // UTS
+            if( delta.kind == servant_kind ){
+                const auto& token = s_tokens.get( delta.id, "token with specified ID does not exist" );
+                if( token.growth == delta.packed ) {
+                    continue;
+                }
+                s_tokens.modify( token, same_payer, [&]( auto& t ) {
+                    t.growth = delta.packed;
+                });
+            }
+            // UTM
+            if( delta.kind == monster_kind ){
+                const auto& token = m_tokens.get( delta.id, "token with specified ID does not exist" );
+                if( token.growth == delta.packed ) {
+                    continue;
+                }
+                m_tokens.modify( token, same_payer, [&]( auto& t ) {
+                    t.growth = delta.packed;
+                });
+            }
+            // UTI
+            if( delta.kind == item_kind ){
+                const auto& token = i_tokens.get( delta.id, "token with specified ID does not exist" );
+                if( token.growth == delta.packed ) {
+                    continue;
+                }
+                i_tokens.modify( token, same_payer, [&]( auto& t ) {
+                    t.growth = delta.packed;
+                });
+            }
+
+            changed[delta.kind].push_back( delta.id );
+        }
+
+        for( uint8_t kind = 0; kind < kind_count; ++kind ) {
+            if( !changed[kind].empty() ) {
+                emit_event( event_stats, kind, _self, _self, changed[kind] );
+            }
+        }
     }
 
-    void devtooth_nft::sub_supply( asset quantity ) {
-        auto symbol_name = quantity.symbol.name();
-        currency_index currency_table( _self, symbol_name );
-        auto current_currency = currency_table.find( symbol_name );
+    ACTION devtooth_nft::auction( account_type seller, uint8_t kind, id_type id, uint8_t type, asset start_price, asset end_price, uint32_t duration )
+    {
+        require_auth( seller );
+        eosio_assert( kind < kind_count, "invalid token kind" );
+        eosio_assert( type == english_auction || type == dutch_auction, "invalid auction type" );
+        eosio_assert( start_price.is_valid() && end_price.is_valid(), "invalid price" );
+        eosio_assert( start_price.symbol == S(4, EOS) && end_price.symbol == S(4, EOS), "price must be in EOS" );
+        eosio_assert( start_price.amount > 0 && end_price.amount >= 0, "invalid price" );
+        eosio_assert( type == english_auction || end_price < start_price, "dutch auction price must decrease" );
+        eosio_assert( duration > 0, "duration must be positive" );
+        eosio_assert( now() + duration > now(), "duration overflow" );
+
+        // 만료된 대여/잠금은 접근 시점에 해제
+        expire_lease( id );
+
+        // UTS
+        if( kind == servant_kind ){
+            auto target_token = s_tokens.find( id );
+            eosio_assert( target_token != s_tokens.end(), "token with specified ID does not exist" );
+            eosio_assert( target_token->owner == seller, "sender does not own token with specified ID");
+            eosio_assert( target_token->state == "idle", "a non-tradeable token");
+            eosio_assert( !target_token->has_equipment(), "unequip items before auction" );
+
+            s_tokens.modify( target_token, seller, [&]( auto& token ) {
+                token.state = "auction";
+            });
+        }
+        // UTM
+        if( kind == monster_kind ){
+            auto target_token = m_tokens.find( id );
+            eosio_assert( target_token != m_tokens.end(), "token with specified ID does not exist" );
+            eosio_assert( target_token->owner == seller, "sender does not own token with specified ID");
+            eosio_assert( target_token->state == "idle", "a non-tradeable token");
+
+            m_tokens.modify( target_token, seller, [&]( auto& token ) {
+                token.state = "auction";
+            });
+        }
+        // UTI
+        if( kind == item_kind ){
+            auto target_token = i_tokens.find( id );
+            eosio_assert( target_token != i_tokens.end(), "token with specified ID does not exist" );
+            eosio_assert( target_token->owner == seller, "sender does not own token with specified ID");
+            eosio_assert( target_token->state == "idle", "a non-tradeable token");
+
+            i_tokens.modify( target_token, seller, [&]( auto& token ) {
+                token.state = "auction";
+            });
+        }
 
-        currency_table.modify( current_currency, 0, [&]( auto& currency ) {
-            currency.supply -= quantity;
+        auction_index auctions( _self, scope_of(_self) );
+        auctions.emplace( seller, [&]( auto& a ) {
+            a.idx = id;
+            a.kind = kind;
+            a.type = type;
+            a.seller = seller;
+            a.start_price = start_price;
+            a.end_price = end_price;
+            a.high_bid = asset{ 0, start_price.symbol };
+            a.start = now();
+            a.end = now() + duration;
         });
+
+        merkle_update( kind, id );
+        emit_event( event_auction, kind, seller, seller, { id } );
     }
 
-    void devtooth_nft::add_supply( asset quantity )
+    ACTION devtooth_nft::bid( account_type bidder, id_type id, asset amount )
     {
-        auto symbol_name = quantity.symbol.name();
-        currency_index currency_table( _self, symbol_name );
-        auto current_currency = currency_table.find( symbol_name );
+        require_auth( bidder );
+
+        // 경매 행과 입찰자 / 이전 입찰자의 예치금 행만 갱신
+        auction_index auctions( _self, scope_of(_self) );
+        const auto& a = auctions.get( id, "auction does not exist" );
+        eosio_assert( a.seller != bidder, "seller cannot bid" );
+        eosio_assert( amount.symbol == a.start_price.symbol, "bid symbol mismatch" );
+
+        // 종료된 경매는 입찰 대신 정산
+        if( now() >= a.end ) {
+            settle_auction( a );
+            auctions.erase( a );
+            print( "auction ended" );
+            return;
+        }
+
+        if( a.type == dutch_auction ) {
+            asset price = current_price( a );
+            eosio_assert( amount >= price, "bid is below current price" );
+
+            sub_fund( bidder, price );
+            auctions.modify( a, same_payer, [&]( auto& row ) {
+                row.bidder = bidder;
+                row.high_bid = price;
+            });
+            emit_event( event_bid, a.kind, bidder, a.seller, { id }, price );
+            settle_auction( a );
+            auctions.erase( a );
+            return;
+        }
+
+        eosio_assert( amount >= a.start_price, "bid is below start price" );
+        eosio_assert( amount > a.high_bid, "bid must exceed highest bid" );
 
-        currency_table.modify( current_currency, 0, [&]( auto& currency ) {
-            currency.supply += quantity;
+        sub_fund( bidder, amount );
+        if( a.bidder != account_type() ) {
+            add_fund( a.bidder, a.high_bid );
+        }
+        auctions.modify( a, same_payer, [&]( auto& row ) {
+            row.bidder = bidder;
+            row.high_bid = amount;
         });
+        emit_event( event_bid, a.kind, bidder, a.seller, { id }, amount );
+    }
+
+    ACTION devtooth_nft::claim( id_type id )
+    {
+        auction_index auctions( _self, scope_of(_self) );
+        const auto& a = auctions.get( id, "auction does not exist" );
+        eosio_assert( now() >= a.end, "auction is not over" );
+
+        settle_auction( a );
+        auctions.erase( a );
+    }
+
+    ACTION devtooth_nft::sweep( uint32_t max_count )
+    {
+        auction_index auctions( _self, scope_of(_self) );
+        auto by_end = auctions.get_index<N(byend)>();
+
+        uint32_t count = 0;
+        for( auto it = by_end.begin(); it != by_end.end() && count < max_count; ++count ) {
+            if( it->end > now() ) {
+                break;
+            }
+            settle_auction( *it );
+            it = by_end.erase( it );
+        }
+        print( "settled ", count );
+    }
+
+    ACTION devtooth_nft::withdraw( account_type owner, asset quantity )
+    {
+        require_auth( owner );
+        eosio_assert( quantity.amount > 0, "must withdraw positive quantity" );
+
+        sub_fund( owner, quantity );
+        action( permission_level{ _self, N(active) }, N(eosio.token), N(transfer),
+                std::make_tuple( _self, owner, quantity, string("devtooth withdraw") ) ).send();
+        emit_event( event_withdraw, 0, _self, owner, {}, quantity );
+    }
+
+    void devtooth_nft::ontransfer( account_type from, account_type to, asset quantity, string memo )
+    {
+        // 이 컨트랙트로 들어오는 EOS 만 예치금으로 적립
+        if( from == _self || to != _self ) {
+            return;
+        }
+        eosio_assert( quantity.symbol == S(4, EOS), "only EOS can be deposited" );
+        eosio_assert( quantity.amount > 0, "must deposit positive quantity" );
+
+        add_fund( from, quantity );
+        emit_event( event_deposit, 0, from, _self, {}, quantity );
+    }
+
+    ACTION devtooth_nft::exportrows( uint8_t table, uint32_t budget, bool restart )
+    {
+        require_auth( _self );
+        eosio_assert( table < migrate_table_count, "invalid migrate table" );
+        eosio_assert( budget > 0, "budget must be positive" );
+
+        if( table == migrate_servant ){
+            export_rows( s_tokens, table, budget, restart );
+        }
+        if( table == migrate_monster ){
+            export_rows( m_tokens, table, budget, restart );
+        }
+        if( table == migrate_item ){
+            export_rows( i_tokens, table, budget, restart );
+        }
+        if( table == migrate_template ){
+            template_index templates( _self, scope_of(_self) );
+            export_rows( templates, table, budget, restart );
+        }
+    }
+
+    ACTION devtooth_nft::importrows( uint8_t table, std::vector<char> rows )
+    {
+        require_auth( _self );
+        eosio_assert( table < migrate_table_count, "invalid migrate table" );
+
+        if( table == migrate_template ){
+            template_index templates( _self, scope_of(_self) );
+            import_rows<token_template>( templates, table, rows, []( auto& ) {} );
+            return;
+        }
+
+        // 잔고 / supply / inventory 는 가져온 토큰에서 다시 계산, 대여 / 잠금 / 경매는 옮기지 않으므로 idle 로 복귀
+        // 합계는 정수로 모으고, 심볼은 create 로 등록된 종류의 심볼을 사용
+        stats_table stats( _self, scope_of(_self) );
+        auto st = stats.get_or_default( token_stats{} );
+        eosio_assert( table < st.kinds.size() && st.kinds[table].issuer != account_type(), "token with symbol does not exist. create token before import" );
+        sym_type symbols = st.kinds[table].supply.symbol;
+
+        int64_t imported = 0;
+        id_type last_id = 0;
+        std::vector<std::pair<account_type, id_type>> imported_tokens;
+        auto on_token = [&]( auto& token ) {
+            if( token.state == "rented" || token.state == "locked" || token.state == "auction" ) {
+                token.state = "idle";
+            }
+            eosio_assert( token.value.symbol == symbols, "imported token symbol mismatch" );
+            add_balance( token.owner, token.value, _self );
+            add_inventory( token.owner, table, { token.idx } );
+            record_owner( token.idx, token.owner, _self );
+            imported += token.value.amount;
+            last_id = std::max( last_id, token.idx );
+            imported_tokens.emplace_back( token.owner, token.idx );
+        };
+
+        if( table == migrate_servant ){
+            import_rows<utstoken>( s_tokens, table, rows, on_token );
+        }
+        if( table == migrate_monster ){
+            import_rows<utmtoken>( m_tokens, table, rows, on_token );
+        }
+        if( table == migrate_item ){
+            import_rows<utitoken>( i_tokens, table, rows, on_token );
+        }
+
+        if( imported > 0 ) {
+            add_supply( asset{ imported, symbols } );
+        }
+        for( const auto& t : imported_tokens ) {
+            merkle_update( table, t.second );
+        }
+
+        // 새 계정의 인덱서도 볼 수 있도록 owner 별로 묶어서 issue 이벤트 하나씩
+        std::sort( imported_tokens.begin(), imported_tokens.end() );
+        for( auto first = imported_tokens.begin(); first != imported_tokens.end(); ) {
+            std::vector<id_type> ids;
+            auto last = first;
+            for( ; last != imported_tokens.end() && last->first == first->first; ++last ) {
+                ids.push_back( last->second );
+            }
+            emit_event( event_issue, table, _self, first->first, ids );
+            first = last;
+        }
+
+        // 같은 샤드의 아이디라면 이후 발급이 겹치지 않도록 next_id 를 올림
+        global_id_table global_ids( _self, scope_of(_self) );
+        auto ids = load_ids( global_ids );
+        if( last_id >= ids.next_id && (last_id >> shard_id_shift) == (ids.next_id >> shard_id_shift) ) {
+            ids.next_id = last_id + 1;
+            global_ids.set( ids, _self );
+        }
+    }
+
+    template<typename Index>
+    void devtooth_nft::export_rows( const Index& rows, uint8_t table, uint32_t budget, bool restart )
+    {
+        migration_index states( _self, scope_of(N(export)) );
+        auto state = states.find( table );
+        if( state == states.end() ) {
+            state = states.emplace( _self, [&]( auto& s ) {
+                s.table = table;
+            });
+        } else if( restart ) {
+            states.modify( state, same_payer, [&]( auto& s ) {
+                s = migration_state{};
+                s.table = table;
+            });
+        }
+
+        // cursor 부터 budget 개의 행을 pack 해서 hex 로 출력, importrows 에 그대로 넘김
+        std::vector<typename std::decay<decltype(*rows.begin())>::type> chunk;
+        uint64_t cursor = state->cursor;
+        uint64_t checksum = state->checksum;
+        auto row = rows.lower_bound( cursor );
+        for( ; row != rows.end() && chunk.size() < budget; ++row ) {
+            checksum = chain_checksum( checksum, pack( *row ) );
+            chunk.push_back( *row );
+            cursor = row->primary_key() + 1;
+        }
+
+        states.modify( state, same_payer, [&]( auto& s ) {
+            s.cursor = cursor;
+            s.count += chunk.size();
+            s.checksum = checksum;
+        });
+
+        auto data = pack( chunk );
+        printhex( data.data(), data.size() );
+        print( row == rows.end() ? "\ndone " : "\nnext ", cursor, " count ", state->count, " checksum ", checksum );
+    }
+
+    template<typename Row, typename Index, typename Fn>
+    void devtooth_nft::import_rows( Index& rows, uint8_t table, const std::vector<char>& data, Fn&& on_row )
+    {
+        migration_index states( _self, scope_of(N(import)) );
+        auto state = states.find( table );
+        if( state == states.end() ) {
+            state = states.emplace( _self, [&]( auto& s ) {
+                s.table = table;
+            });
+        }
+
+        // checksum 은 export 와 같은 바이트로 계산한 뒤 행을 보정
+        uint64_t checksum = state->checksum;
+        auto chunk = unpack<std::vector<Row>>( data );
+        for( auto& row : chunk ) {
+            checksum = chain_checksum( checksum, pack( row ) );
+            on_row( row );
+            rows.emplace( _self, [&]( auto& r ) {
+                r = row;
+            });
+        }
+
+        states.modify( state, same_payer, [&]( auto& s ) {
+            s.count += chunk.size();
+            s.checksum = checksum;
+        });
+        print( "count ", state->count, " checksum ", checksum );
+    }
+
+    uint64_t devtooth_nft::chain_checksum( uint64_t checksum, const std::vector<char>& row )
+    {
+        std::vector<char> data( sizeof(checksum) );
+        std::copy( reinterpret_cast<const char*>(&checksum), reinterpret_cast<const char*>(&checksum) + sizeof(checksum), data.begin() );
+        data.insert( data.end(), row.begin(), row.end() );
+        return content_key( data );
+    }
+
+    ACTION devtooth_nft::merklefill( uint8_t kind, uint64_t cursor, uint32_t budget )
+    {
+        // 머클 트리 이전에 발급된 토큰의 잎을 cursor 부터 budget 개씩 채움, 이미 같은 잎은 건너뜀
+        require_auth( _self );
+        eosio_assert( kind < kind_count, "invalid token kind" );
+        eosio_assert( budget > 0, "budget must be positive" );
+
+        std::vector<id_type> ids;
+        bool done = false;
+        uint64_t next = 0;
+
+        // UTS
+        if( kind == servant_kind ){
+            auto token = s_tokens.lower_bound( cursor );
+            for( ; token != s_tokens.end() && ids.size() < budget; ++token ) {
+                ids.push_back( token->idx );
+            }
+            done = token == s_tokens.end();
+            next = done ? 0 : token->idx;
+        }
+        // UTM
+        if( kind == monster_kind ){
+            auto token = m_tokens.lower_bound( cursor );
+            for( ; token != m_tokens.end() && ids.size() < budget; ++token ) {
+                ids.push_back( token->idx );
+            }
+            done = token == m_tokens.end();
+            next = done ? 0 : token->idx;
+        }
+        // UTI
+        if( kind == item_kind ){
+            auto token = i_tokens.lower_bound( cursor );
+            for( ; token != i_tokens.end() && ids.size() < budget; ++token ) {
+                ids.push_back( token->idx );
+            }
+            done = token == i_tokens.end();
+            next = done ? 0 : token->idx;
+        }
+
+        for( auto id : ids ) {
+            merkle_update( kind, id );
+        }
+
+        // 다음 호출에서 사용할 cursor
+        if( done ) {
+            print( "done" );
+        } else {
+            print( "next ", next );
+        }
+    }
+
+    ACTION devtooth_nft::merkleproof( uint8_t kind, id_type id )
+    {
+        // 포함 증명 출력 : slot, height, root, 잎 해시, 잎 쪽부터 height 개의 형제 노드 (빈 서브트리는 0)
+        // tools/devtooth_proof.hpp 의 verify 에 그대로 넘겨 검증
+        eosio_assert( kind < kind_count, "invalid token kind" );
+
+        merkle_leaf_index leaves( _self, scope_of(_self) );
+        auto by_token = leaves.get_index<N(bytoken)>();
+        auto leaf = by_token.find( token_key( kind, id ) );
+        eosio_assert( leaf != by_token.end(), "token has no merkle leaf" );
+
+        merkle_table merkle( _self, scope_of(_self) );
+        auto m = merkle.get_or_default( merkle_info{} );
+
+        std::vector<char> data = bytes_of( m.root );
+        print( "slot ", leaf->slot, " height ", uint32_t(m.height), " root " );
+        printhex( data.data(), data.size() );
+        data = bytes_of( leaf->hash );
+        print( " leaf " );
+        printhex( data.data(), data.size() );
+
+        print( " path" );
+        uint64_t index = leaf->slot;
+        for( uint8_t level = 0; level < m.height; ++level ) {
+            data = bytes_of( merkle_node_at( level, index ^ 1 ) );
+            print( " " );
+            printhex( data.data(), data.size() );
+            index >>= 1;
+        }
+    }
+
+    ACTION devtooth_nft::gctemplate( uint32_t max_count )
+    {
+        // 참조가 없는 템플릿은 byrefcount 앞쪽에 모여 있으므로 max_count 개만 지움
+        template_index templates( _self, scope_of(_self) );
+        auto by_refcount = templates.get_index<N(byrefcount)>();
+
+        uint32_t count = 0;
+        for( auto itr = by_refcount.begin(); itr != by_refcount.end() && itr->refcount == 0 && count < max_count; ++count ) {
+            itr = by_refcount.erase( itr );
+        }
+        print( "removed ", count );
+    }
+
+    ACTION devtooth_nft::gctokens( uint8_t kind, uint64_t cursor, uint32_t budget )
+    {
+        require_auth( _self );
+        eosio_assert( kind < kind_count, "invalid token kind" );
+        eosio_assert( budget > 0, "budget must be positive" );
+
+        // UTS
+        if( kind == servant_kind ){
+            collect_orphans<servant_table>( s_tokens, kind, cursor, budget );
+        }
+        // UTM
+        if( kind == monster_kind ){
+            collect_orphans<monster_table>( m_tokens, kind, cursor, budget );
+        }
+        // UTI
+        if( kind == item_kind ){
+            collect_orphans<item_table>( i_tokens, kind, cursor, budget );
+        }
+    }
+
+    template<typename PreTable, typename TokenIndex>
+    void devtooth_nft::collect_orphans( TokenIndex& tokens, uint8_t kind, uint64_t cursor, uint32_t budget )
+    {
+        // 게임 컨트랙트에 원본 행이 없는 토큰을 회수, 대여 / 잠금 / 경매 / 장착 중인 토큰은 건너뜀
+        uint32_t removed = 0;
+        uint32_t skipped = 0;
+        uint64_t freed = 0;
+        asset burned;
+        std::vector<std::pair<account_type, id_type>> burned_tokens;
+
+        auto token = tokens.lower_bound( cursor );
+        for( uint32_t visited = 0; token != tokens.end() && visited < budget; ++visited ) {
+            PreTable rows( N(unlimittest1), scope_of(token->master) );
+            if( rows.find( token->t_idx ) != rows.end() ) {
+                ++token;
+                continue;
+            }
+
+            // 만료된 대여/잠금은 여기서 해제해야 회수 대상이 됨
+            expire_lease( token->idx );
+            if( (token->state != "idle" && token->state != "selling") || holds_items( *token ) ) {
+                ++skipped;
+                ++token;
+                continue;
+            }
+
+            id_type id = token->idx;
+            account_type owner = token->owner;
+            asset value = token->value;
+
+            freed += row_ram( *token, 2, 1 );
+            release_template( token->template_id );
+            token = tokens.erase( token );
+            erase_history( id );
+            sub_balance( owner, value );
+            sub_inventory( owner, kind, id );
+
+            burned = removed == 0 ? value : burned + value;
+            merkle_update( kind, id );
+
+            ++removed;
+            burned_tokens.emplace_back( owner, id );
+        }
+
+        if( removed > 0 ) {
+            sub_supply( burned );
+        }
+
+        // owner 별로 묶어서 burn 이벤트 하나씩
+        std::sort( burned_tokens.begin(), burned_tokens.end() );
+        for( auto first = burned_tokens.begin(); first != burned_tokens.end(); ) {
+            std::vector<id_type> ids;
+            auto last = first;
+            for( ; last != burned_tokens.end() && last->first == first->first; ++last ) {
+                ids.push_back( last->second );
+            }
+            emit_event( event_burn, kind, first->first, _self, ids );
+            first = last;
+        }
+
+        // 다음 호출에서 사용할 cursor
+        if( token == tokens.end() ) {
+            print( "done" );
+        } else {
+            print( "next ", token->idx );
+        }
+        print( " removed ", removed, " skipped ", skipped, " freed ", freed );
+    }
+
+    ACTION devtooth_nft::purge( uint8_t kind, uint32_t budget )
+    {
+        require_auth( _self );
+        eosio_assert( kind < kind_count, "invalid token kind" );
+        eosio_assert( budget > 0, "budget must be positive" );
+
+        print( purge_tokens( kind, budget, true ) ? "done" : "more" );
+    }
+
+    bool devtooth_nft::purge_tokens( uint8_t kind, uint32_t budget, bool keep_tree )
+    {
+        // 레이아웃이 바뀌어 multi_index 로 풀 수 없는 행도 지울 수 있도록 raw db API 로 처리
+        // 모든 레이아웃에서 같은 앞부분 (idx, t_idx, state, owner, master, value) 만 읽어 잔액 / supply / 부가 행을 되돌림
+        uint64_t table = 0;
+        // UTS
+        if( kind == servant_kind ){
+            table = scope_of( N(utstokens) );
+        }
+        // UTM
+        if( kind == monster_kind ){
+            table = scope_of( N(utmtokens) );
+        }
+        // UTI
+        if( kind == item_kind ){
+            table = scope_of( N(utitokens) );
+        }
+
+        // 보조 인덱스 테이블 이름은 하위 4 bit 가 인덱스 번호 : byowner 0, bymaster 1, bypower 2
+        uint64_t code = scope_of(_self);
+        uint64_t index_table = table & 0xFFFFFFFFFFFFFFF0ULL;
+
+        lease_index leases( _self, scope_of(_self) );
+        auction_index auctions( _self, scope_of(_self) );
+        inventory_index inventories( _self, scope_of(_self) );
+
+        uint32_t removed = 0;
+        asset burned;
+        std::vector<std::pair<account_type, id_type>> burned_tokens;
+
+        int32_t itr = db_lowerbound_i64( code, code, table, 0 );
+        for( ; itr >= 0 && removed < budget; itr = db_lowerbound_i64( code, code, table, 0 ) ) {
+            std::vector<char> row( db_get_i64( itr, nullptr, 0 ) );
+            db_get_i64( itr, row.data(), row.size() );
+
+            id_type id;
+            uint32_t t_idx;
+            string state;
+            account_type owner;
+            account_type master;
+            asset value;
+            datastream<const char*> ds( row.data(), row.size() );
+            ds >> id >> t_idx >> state >> owner >> master >> value;
+
+            // bymaster, bypower 가 없던 레이아웃도 있으므로 있는 보조 인덱스만 지움
+            uint64_t secondary64;
+            uint128_t secondary128;
+            int32_t sec = db_idx64_find_primary( code, code, index_table | 0, &secondary64, id );
+            if( sec >= 0 ) {
+                db_idx64_remove( sec );
+            }
+            sec = db_idx128_find_primary( code, code, index_table | 1, &secondary128, id );
+            if( sec >= 0 ) {
+                db_idx128_remove( sec );
+            }
+            sec = db_idx64_find_primary( code, code, index_table | 2, &secondary64, id );
+            if( sec >= 0 ) {
+                db_idx64_remove( sec );
+            }
+            db_remove_i64( itr );
+
+            account_index accounts( _self, scope_of(owner) );
+            if( accounts.find( sym_code(value.symbol) ) != accounts.end() ) {
+                sub_balance( owner, value );
+            }
+            erase_history( id );
+
+            auto l = leases.find( id );
+            if( l != leases.end() && l->kind == kind ) {
+                leases.erase( l );
+            }
+
+            // 최고 입찰액은 입찰자 예치금으로 돌려줌
+            auto a = auctions.find( id );
+            if( a != auctions.end() && a->kind == kind ) {
+                if( a->bidder != account_type() && a->high_bid.amount > 0 ) {
+                    add_fund( a->bidder, a->high_bid );
+                }
+                auctions.erase( a );
+            }
+
+            // inventory 이전에 발급된 토큰은 항목이 없음
+            auto inv = inventories.find( scope_of(owner) );
+            if( inv != inventories.end() && std::binary_search( inv->entries.begin(), inv->entries.end(), inventory_entry{ kind, id } ) ) {
+                sub_inventory( owner, kind, id );
+            }
+
+            if( keep_tree ) {
+                merkle_update( kind, id );
+            }
+
+            burned = removed == 0 ? value : burned + value;
+            ++removed;
+            burned_tokens.emplace_back( owner, id );
+        }
+
+        if( removed > 0 ) {
+            sub_supply( burned );
+        }
+
+        // owner 별로 묶어서 burn 이벤트 하나씩
+        std::sort( burned_tokens.begin(), burned_tokens.end() );
+        for( auto first = burned_tokens.begin(); first != burned_tokens.end(); ) {
+            std::vector<id_type> ids;
+            auto last = first;
+            for( ; last != burned_tokens.end() && last->first == first->first; ++last ) {
+                ids.push_back( last->second );
+            }
+            emit_event( event_burn, kind, first->first, _self, ids );
+            first = last;
+        }
+
+        return itr < 0;
+    }
+
+    template<typename T>
+    uint64_t devtooth_nft::row_ram( const T& row, uint8_t index64_count, uint8_t index128_count )
+    {
+        return row_overhead + pack_size( row ) + index64_count * index64_overhead + index128_count * index128_overhead;
+    }
+
+    ACTION devtooth_nft::ramreport( uint32_t users, uint32_t servants, uint32_t monsters, uint32_t items )
+    {
+        // 행 크기는 가장 긴 상태 문자열, 서번트는 장비 슬롯이 모두 찬 경우 기준
+        utstoken uts{};
+        uts.state = "equipped";
+        uts.equip_slot.resize( servant_slot_count );
+        utmtoken utm{};
+        utm.state = "equipped";
+        utitoken uti{};
+        uti.state = "equipped";
+
+        config_table configs( _self, scope_of(_self) );
+        token_history h{};
+        h.records.resize( configs.get_or_default( config_info{} ).history_depth );
+
+        token_stats st{};
+        st.kinds.resize( kind_count );
+
+        // 토큰 테이블 : byowner, bypower (i64) + bymaster (i128)
+        uint64_t uts_ram = row_ram( uts, 2, 1 );
+        uint64_t utm_ram = row_ram( utm, 2, 1 );
+        uint64_t uti_ram = row_ram( uti, 2, 1 );
+        uint64_t account_ram = row_ram( account{}, 0, 0 );
+        uint64_t history_ram = h.records.empty() ? 0 : row_ram( h, 0, 0 );
+        uint64_t lease_ram = row_ram( lease{}, 1, 0 );
+        uint64_t tservant_ram = row_ram( tservant{}, 0, 0 );
+        uint64_t tmonster_ram = row_ram( tmonster{}, 0, 0 );
+        uint64_t titem_ram = row_ram( titem{}, 0, 0 );
+        uint64_t template_ram = row_ram( token_template{}, 1, 0 );
+        uint64_t auction_ram = row_ram( auction_info{}, 2, 0 );
+        uint64_t fund_ram = row_ram( fund{}, 0, 0 );
+
+        print( "utstoken ", uts_ram, "\n" );
+        print( "utmtoken ", utm_ram, "\n" );
+        print( "utitoken ", uti_ram, "\n" );
+        print( "account ", account_ram, "\n" );
+        print( "history ", history_ram, "\n" );
+        print( "lease ", lease_ram, "\n" );
+        print( "tservant ", tservant_ram, "\n" );
+        print( "tmonster ", tmonster_ram, "\n" );
+        print( "titem ", titem_ram, "\n" );
+        print( "template ", template_ram, "\n" );
+        print( "auction ", auction_ram, "\n" );
+        print( "fund ", fund_ram, "\n" );
+
+        // owner : issue 로 받은 토큰 행, 종류별 잔고 행과 accounts 테이블, 보낸 토큰의 history 행
+        // (migrate 로 옮긴 토큰은 같은 크기를 _self 가 부담)
+        uint64_t tokens = uint64_t(servants) + monsters + items;
+        uint64_t held_kinds = (servants > 0) + (monsters > 0) + (items > 0);
+        uint64_t per_owner = servants * uts_ram + monsters * utm_ram + items * uti_ram + tokens * history_ram;
+        if( held_kinds > 0 ) {
+            per_owner += table_overhead + held_kinds * account_ram;
+        }
+
+        // _self : 싱글톤 4 개와 _self scope 테이블 (보조 인덱스마다 table_id 추가)
+        uint64_t self_ram = row_ram( st, 0, 0 ) + row_ram( global_id{}, 0, 0 ) + row_ram( shard_info{}, 0, 0 ) + row_ram( config_info{}, 0, 0 );
+        self_ram += 4 * table_overhead;
+        self_ram += kind_count * 4 * table_overhead;  // utstokens, utmtokens, utitokens + 보조 인덱스 3 개
+        self_ram += 2 * table_overhead;               // leases + byexpiry
+        self_ram += 4 * table_overhead;               // history, inventory, templates + byrefcount
+
+        self_ram += 3 * table_overhead;               // auctions + byend, byhighbid
+        self_ram += table_overhead;                   // funds
+
+        // 예치금 행은 _self 가 부담, 유저마다 하나로 가정 (경매 행은 판매자가 부담하고 정산 시 반환)
+        self_ram += uint64_t(users) * fund_ram;
+
+        // 템플릿은 같은 고정 속성을 가진 토큰끼리 공유, 최악의 경우 토큰마다 하나
+        uint64_t templates_max = uint64_t(users) * tokens * template_ram;
+
+        // 머클 트리 : 토큰마다 잎 하나 (bytoken i128) 와 내부 노드 약 하나
+        uint64_t merkle_ram = row_ram( merkle_leaf{}, 0, 1 ) + row_ram( merkle_node{}, 0, 0 );
+        self_ram += row_ram( merkle_info{}, 0, 0 ) + 3 * table_overhead;
+        self_ram += uint64_t(users) * tokens * merkle_ram;
+
+        // inventory : 유저마다 행 하나, 보유 토큰 수만큼 항목
+        if( tokens > 0 ) {
+            inventory inv{};
+            inv.entries.resize( tokens );
+            self_ram += uint64_t(users) * row_ram( inv, 0, 0 );
+        }
+
+        // 게임 컨트랙트 : 유저 scope 의 사전 등록 테이블
+        uint64_t per_game = servants * tservant_ram + monsters * tmonster_ram + items * titem_ram + held_kinds * table_overhead;
+
+        print( "users ", users, " tokens ", uint64_t(users) * tokens, "\n" );
+        print( "owner ", uint64_t(users) * per_owner, " (", per_owner, " per user)\n" );
+        print( "_self ", self_ram, "\n" );
+        print( "templates ", templates_max, " (upper bound, paid by the first minter)\n" );
+        print( "game ", uint64_t(users) * per_game, " (", per_game, " per user)\n" );
+    }
+
+    ACTION devtooth_nft::logevent( uint8_t version, uint8_t type, uint8_t kind, account_type from, account_type to, std::vector<id_type> ids, asset quantity )
+    {
+        // indexer 가 action trace 에서 읽기 위한 기록용 action, 상태 변경 없음
+        require_auth( _self );
+    }
+
+    void devtooth_nft::emit_event( uint8_t type, uint8_t kind, account_type from, account_type to, const std::vector<id_type>& ids, asset quantity )
+    {
+        action( permission_level{ _self, N(active) }, _self, N(logevent),
+                std::make_tuple( uint8_t(event_version), type, kind, from, to, ids, quantity ) ).send();
+    }
+
+    devtooth_nft::node_hash devtooth_nft::digest_of( const std::vector<char>& data )
+    {
+        hash_type hash = content_digest( data );
+
+        node_hash h;
+        for( int i = 0; i < 16; ++i ) {
+            h.high = (h.high << 8) | hash.hash[i];
+            h.low = (h.low << 8) | hash.hash[16 + i];
+        }
+        return h;
+    }
+
+    devtooth_nft::node_hash devtooth_nft::combine( const node_hash& left, const node_hash& right )
+    {
+        // 빈 서브트리 둘의 부모도 빈 서브트리
+        if( left.empty() && right.empty() ) {
+            return node_hash{};
+        }
+
+        std::vector<char> data = bytes_of( left );
+        std::vector<char> tail = bytes_of( right );
+        data.insert( data.end(), tail.begin(), tail.end() );
+        return digest_of( data );
+    }
+
+    std::vector<char> devtooth_nft::bytes_of( const node_hash& h )
+    {
+        // high, low 순서의 big endian 32 byte, sha256 출력과 같은 순서
+        std::vector<char> data( 32 );
+        for( int i = 0; i < 16; ++i ) {
+            data[15 - i] = char( h.high >> (8 * i) );
+            data[31 - i] = char( h.low >> (8 * i) );
+        }
+        return data;
+    }
+
+    devtooth_nft::node_hash devtooth_nft::merkle_node_at( uint8_t level, uint64_t index )
+    {
+        if( level == 0 ) {
+            merkle_leaf_index leaves( _self, scope_of(_self) );
+            auto leaf = leaves.find( index );
+            return leaf == leaves.end() ? node_hash{} : leaf->hash;
+        }
+
+        merkle_node_index nodes( _self, level );
+        auto node = nodes.find( index );
+        return node == nodes.end() ? node_hash{} : node->hash;
+    }
+
+    void devtooth_nft::set_merkle_node( uint8_t level, uint64_t index, const node_hash& hash )
+    {
+        merkle_node_index nodes( _self, level );
+        auto node = nodes.find( index );
+        if( hash.empty() ) {
+            if( node != nodes.end() ) {
+                nodes.erase( node );
+            }
+        } else if( node == nodes.end() ) {
+            nodes.emplace( _self, [&]( auto& n ) {
+                n.index = index;
+                n.hash = hash;
+            });
+        } else {
+            nodes.modify( node, same_payer, [&]( auto& n ) {
+                n.hash = hash;
+            });
+        }
+    }
+
+    void devtooth_nft::merkle_path( merkle_info& m, uint64_t slot )
+    {
+        // slot 의 잎에서 root 까지 height 개 노드를 다시 계산
+        node_hash h = merkle_node_at( 0, slot );
+        uint64_t index = slot;
+        for( uint8_t level = 0; level < m.height; ++level ) {
+            node_hash sibling = merkle_node_at( level, index ^ 1 );
+            h = (index & 1) ? combine( sibling, h ) : combine( h, sibling );
+            index >>= 1;
+            set_merkle_node( level + 1, index, h );
+        }
+        m.root = h;
+    }
+
+    void devtooth_nft::merkle_update( uint8_t kind, id_type id )
+    {
+        bool exists = false;
+        std::vector<char> data;
+
+        // UTS
+        if( kind == servant_kind ){
+            auto token = s_tokens.find( id );
+            if( token != s_tokens.end() ) {
+                exists = true;
+                data = pack( std::make_tuple( kind, id, token->owner, token->state ) );
+            }
+        }
+        // UTM
+        if( kind == monster_kind ){
+            auto token = m_tokens.find( id );
+            if( token != m_tokens.end() ) {
+                exists = true;
+                data = pack( std::make_tuple( kind, id, token->owner, token->state ) );
+            }
+        }
+        // UTI
+        if( kind == item_kind ){
+            auto token = i_tokens.find( id );
+            if( token != i_tokens.end() ) {
+                exists = true;
+                data = pack( std::make_tuple( kind, id, token->owner, token->state ) );
+            }
+        }
+
+        merkle_table merkle( _self, scope_of(_self) );
+        auto m = merkle.get_or_default( merkle_info{} );
+
+        merkle_leaf_index leaves( _self, scope_of(_self) );
+        auto by_token = leaves.get_index<N(bytoken)>();
+        auto leaf = by_token.find( token_key( kind, id ) );
+
+        if( exists ) {
+            node_hash h = digest_of( data );
+            uint64_t slot;
+            if( leaf == by_token.end() ) {
+                // 새 잎은 맨 뒤 slot, 2^height 를 넘으면 (root, 빈 서브트리) 위에 새 root
+                slot = m.leaf_count++;
+                while( (slot >> m.height) != 0 ) {
+                    m.height += 1;
+                    m.root = combine( m.root, node_hash{} );
+                    set_merkle_node( m.height, 0, m.root );
+                }
+                leaves.emplace( _self, [&]( auto& l ) {
+                    l.slot = slot;
+                    l.kind = kind;
+                    l.id = id;
+                    l.hash = h;
+                });
+            } else {
+                if( leaf->hash == h ) {
+                    return;
+                }
+                slot = leaf->slot;
+                by_token.modify( leaf, same_payer, [&]( auto& l ) {
+                    l.hash = h;
+                });
+            }
+            merkle_path( m, slot );
+        } else if( leaf != by_token.end() ) {
+            // 마지막 잎을 빈 자리로 옮겨 slot 을 빈틈 없이 유지
+            uint64_t slot = leaf->slot;
+            uint64_t last = m.leaf_count - 1;
+            if( slot != last ) {
+                auto moved = leaves.get( last, "merkle leaf does not exist" );
+                leaves.modify( leaves.get( slot, "merkle leaf does not exist" ), same_payer, [&]( auto& l ) {
+                    l.kind = moved.kind;
+                    l.id = moved.id;
+                    l.hash = moved.hash;
+                });
+                merkle_path( m, slot );
+            }
+            leaves.erase( leaves.get( last, "merkle leaf does not exist" ) );
+            m.leaf_count = last;
+            merkle_path( m, last );
+        } else {
+            return;
+        }
+
+        merkle.set( m, _self );
+    }
+
+    devtooth_nft::combat_stats devtooth_nft::make_stats( const status_info& status, uint32_t atk, uint32_t def )
+    {
+        combat_stats stats;
+        stats.total_str = status.basic_str + status.plus_str;
+        stats.total_dex = status.basic_dex + status.plus_dex;
+        stats.total_int = status.basic_int + status.plus_int;
+        stats.atk = atk;
+        stats.def = def;
+        return stats;
+    }
+
+    uint8_t devtooth_nft::kind_of( sym_type symbols )
+    {
+        if( symbols == S(0, UTS) ) {
+            return servant_kind;
+        }
+        if( symbols == S(0, UTM) ) {
+            return monster_kind;
+        }
+        eosio_assert( symbols == S(0, UTI), "invalid symbol name" );
+        return item_kind;
+    }
+
+    ACTION devtooth_nft::setshard( uint8_t index, uint8_t count, uint8_t kind_mask, bool by_owner )
+    {
+        require_auth( _self );
+        eosio_assert( count > 0 && index < count, "invalid shard index" );
+        eosio_assert( kind_mask != 0 && kind_mask < (1 << kind_count), "invalid kind mask" );
+
+        // 이미 발급한 아이디가 있으면 상위 8 bit 를 바꿀 수 없음 (다른 샤드의 아이디와 겹치거나 같은 계정 안에서 두 접두어가 섞임)
+        global_id_table global_ids( _self, scope_of(_self) );
+        global_id ids = load_ids( global_ids );
+        bool issued = s_tokens.begin() != s_tokens.end() || m_tokens.begin() != m_tokens.end() || i_tokens.begin() != i_tokens.end();
+        issued = issued || ( global_ids.exists() && (ids.next_id & local_id_mask) > 1 );
+        eosio_assert( !issued || (ids.next_id >> shard_id_shift) == index, "token ids already issued under another shard index" );
+
+        shard_table shard( _self, scope_of(_self) );
+        shard.set( shard_info{ index, count, kind_mask, by_owner }, _self );
+
+        // 이후 발급하는 아이디의 상위 8 bit 를 샤드 번호로 교체
+        ids.next_id = (uint64_t(index) << shard_id_shift) | (ids.next_id & local_id_mask);
+        global_ids.set( ids, _self );
+    }
+
+    void devtooth_nft::check_shard( uint8_t kind, account_type owner )
+    {
+        shard_table shard( _self, scope_of(_self) );
+        if( !shard.exists() ) {
+            return;
+        }
+
+        auto info = shard.get();
+        eosio_assert( (info.kind_mask >> kind) & 1, "token kind is served by another shard" );
+        // 이름 값의 하위 bit 는 대부분 0 이므로 sha256 으로 섞은 값으로 분할
+        eosio_assert( !info.by_owner || content_key( pack( owner ) ) % info.count == info.index, "owner is served by another shard" );
+    }
+
+    devtooth_nft::global_id devtooth_nft::load_ids( global_id_table& global_ids )
+    {
+        if( global_ids.exists() ) {
+            return global_ids.get();
+        }
+
+        // 첫 발급 : 기존 토큰 테이블의 아이디와 겹치지 않도록 가장 큰 키 다음부터 시작
+        global_id ids;
+        ids.next_id = std::max( ids.next_id, s_tokens.available_primary_key() );
+        ids.next_id = std::max( ids.next_id, m_tokens.available_primary_key() );
+        ids.next_id = std::max( ids.next_id, i_tokens.available_primary_key() );
+        return ids;
+    }
+
+    id_type devtooth_nft::reserve_ids( uint64_t count )
+    {
+        eosio_assert( count > 0, "must reserve at least one id" );
+
+        global_id_table global_ids( _self, scope_of(_self) );
+        global_id ids = load_ids( global_ids );
+
+        // 샤드 번호 (상위 8 bit) 를 넘어가지 않는 범위에서만 발급
+        id_type first = ids.next_id;
+        eosio_assert( count <= local_id_mask - (first & local_id_mask) + 1, "token id space exhausted" );
+        ids.next_id += count;
+        global_ids.set( ids, _self );
+
+        return first;
+    }
+
+    asset devtooth_nft::current_price( const auction_info& a )
+    {
+        if( a.type == english_auction ) {
+            return a.high_bid;
+        }
+
+        // dutch : start ~ end 동안 시작가에서 종료가로 선형 감소, 가격 차 * 경과 시간은 int64 를 넘을 수 있어 int128 로 계산
+        uint32_t elapsed = std::min( now(), a.end ) - a.start;
+        int128_t drop = int128_t(a.start_price.amount - a.end_price.amount) * elapsed / (a.end - a.start);
+        return asset{ a.start_price.amount - int64_t(drop), a.start_price.symbol };
+    }
+
+    void devtooth_nft::settle_auction( const auction_info& a )
+    {
+        // 입찰이 없으면 판매자에게 돌려줌, 정산 RAM 은 호출자 대신 _self 가 부담
+        account_type winner = a.bidder == account_type() ? a.seller : a.bidder;
+        asset value;
+
+        // UTS
+        if( a.kind == servant_kind ){
+            const auto& token = s_tokens.get( a.idx, "token with specified ID does not exist" );
+            value = token.value;
+            s_tokens.modify( token, same_payer, [&]( auto& t ) {
+                t.owner = winner;
+                t.state = "idle";
+            });
+        }
+        // UTM
+        if( a.kind == monster_kind ){
+            const auto& token = m_tokens.get( a.idx, "token with specified ID does not exist" );
+            value = token.value;
+            m_tokens.modify( token, same_payer, [&]( auto& t ) {
+                t.owner = winner;
+                t.state = "idle";
+            });
+        }
+        // UTI
+        if( a.kind == item_kind ){
+            const auto& token = i_tokens.get( a.idx, "token with specified ID does not exist" );
+            value = token.value;
+            i_tokens.modify( token, same_payer, [&]( auto& t ) {
+                t.owner = winner;
+                t.state = "idle";
+            });
+        }
+
+        if( winner != a.seller ) {
+            sub_balance( a.seller, value );
+            add_balance( winner, value, _self );
+            record_owner( a.idx, winner, _self );
+            sub_inventory( a.seller, a.kind, a.idx );
+            add_inventory( winner, a.kind, { a.idx } );
+            add_fund( a.seller, a.high_bid );
+        }
+
+        merkle_update( a.kind, a.idx );
+        emit_event( event_settle, a.kind, a.seller, winner, { a.idx }, a.high_bid );
+    }
+
+    void devtooth_nft::add_fund( account_type owner, asset quantity )
+    {
+        fund_index funds( _self, scope_of(_self) );
+        auto existing = funds.find( scope_of(owner) );
+        if( existing == funds.end() ) {
+            funds.emplace( _self, [&]( auto& f ) {
+                f.owner = owner;
+                f.balance = quantity;
+            });
+        } else {
+            funds.modify( existing, same_payer, [&]( auto& f ) {
+                f.balance += quantity;
+            });
+        }
+    }
+
+    void devtooth_nft::sub_fund( account_type owner, asset quantity )
+    {
+        fund_index funds( _self, scope_of(_self) );
+        const auto& f = funds.get( scope_of(owner), "no deposit found" );
+        eosio_assert( f.balance.symbol == quantity.symbol, "symbol mismatch" );
+        eosio_assert( f.balance.amount >= quantity.amount, "insufficient deposit" );
+
+        if( f.balance.amount == quantity.amount ) {
+            funds.erase( f );
+        } else {
+            funds.modify( f, same_payer, [&]( auto& row ) {
+                row.balance -= quantity;
+            });
+        }
+    }
+
+    uint64_t devtooth_nft::acquire_template( const template_attrs& attrs, account_type ram_payer )
+    {
+        auto data = pack( attrs );
+        uint64_t template_id = content_key( data );
+        eosio_assert( template_id != 0, "invalid template id" );
+
+        template_index templates( _self, scope_of(_self) );
+        auto existing = templates.find( template_id );
+        if( existing == templates.end() ) {
+            templates.emplace( ram_payer, [&]( auto& t ) {
+                t.template_id = template_id;
+                t.attrs = attrs;
+                t.refcount = 1;
+            });
+        } else {
+            eosio_assert( pack( existing->attrs ) == data, "template id collision" );
+            templates.modify( existing, same_payer, [&]( auto& t ) {
+                t.refcount += 1;
+            });
+        }
+        return template_id;
+    }
+
+    void devtooth_nft::release_template( uint64_t template_id )
+    {
+        if( template_id == 0 ) {
+            return;
+        }
+
+        template_index templates( _self, scope_of(_self) );
+        const auto& t = templates.get( template_id, "template does not exist" );
+        eosio_assert( t.refcount > 0, "template refcount underflow" );
+        templates.modify( t, same_payer, [&]( auto& row ) {
+            row.refcount -= 1;
+        });
+    }
+
+    void devtooth_nft::add_inventory( account_type owner, uint8_t kind, const std::vector<id_type>& ids )
+    {
+        // 여러 계정의 action 이 같은 행을 키우므로 inventory 행은 항상 _self 가 부담
+        inventory_index inventories( _self, scope_of(_self) );
+        auto existing = inventories.find( scope_of(owner) );
+
+        auto insert = [&]( auto& inv ) {
+            for( auto id : ids ) {
+                inventory_entry entry{ kind, id };
+                auto pos = std::lower_bound( inv.entries.begin(), inv.entries.end(), entry );
+                eosio_assert( pos == inv.entries.end() || entry < *pos, "token already in inventory" );
+                inv.entries.insert( pos, entry );
+            }
+        };
+
+        if( existing == inventories.end() ) {
+            inventories.emplace( _self, [&]( auto& inv ) {
+                inv.owner = owner;
+                insert( inv );
+            });
+        } else {
+            inventories.modify( existing, same_payer, insert );
+        }
+    }
+
+    void devtooth_nft::sub_inventory( account_type owner, uint8_t kind, id_type id )
+    {
+        inventory_index inventories( _self, scope_of(_self) );
+        const auto& inv = inventories.get( scope_of(owner), "no inventory object found" );
+
+        inventory_entry entry{ kind, id };
+        auto pos = std::lower_bound( inv.entries.begin(), inv.entries.end(), entry );
+        eosio_assert( pos != inv.entries.end() && !(entry < *pos), "token not in inventory" );
+
+        if( inv.entries.size() == 1 ) {
+            inventories.erase( inv );
+        } else {
+            auto offset = pos - inv.entries.begin();
+            inventories.modify( inv, same_payer, [&]( auto& i ) {
+                i.entries.erase( i.entries.begin() + offset );
+            });
+        }
+    }
+
+    void devtooth_nft::sub_balance( account_type owner, asset value ) 
+    {
+        account_index from_acnts( _self, scope_of(owner) );
+        const auto& from = from_acnts.get( sym_code(value.symbol), "no balance object found" );
+        eosio_assert( from.balance.amount >= value.amount, "overdrawn balance" );
+
+
+        if( from.balance.amount == value.amount ) {
+            from_acnts.erase( from );
+        } else {
+            from_acnts.modify( from, same_payer, [&]( auto& a ) {
+                a.balance -= value;
+            });
+        }
+    }
+
+    void devtooth_nft::add_balance( account_type owner, asset value, account_type ram_payer )
+    {
+        account_index to_accounts( _self, scope_of(owner) );
+        auto to = to_accounts.find( sym_code(value.symbol) );
+        if( to == to_accounts.end() ) {
+            to_accounts.emplace( ram_payer, [&]( auto& a ){
+                a.balance = value;
+            });
+        } else {
+            to_accounts.modify( to, same_payer, [&]( auto& a ) {
+                a.balance += value;
+            });
+        }
+    }
+
+    void devtooth_nft::sub_supply( asset quantity )
+    {
+        stats_table stats( _self, scope_of(_self) );
+        auto st = stats.get_or_default( token_stats{} );
+        uint8_t kind = kind_of( quantity.symbol );
+        eosio_assert( kind < st.kinds.size() && st.kinds[kind].issuer != account_type(), "token with symbol does not exist" );
+        eosio_assert( st.kinds[kind].supply.amount >= quantity.amount, "supply underflow" );
+
+        st.kinds[kind].supply -= quantity;
+        stats.set( st, _self );
+    }
+
+    void devtooth_nft::add_supply( asset quantity )
+    {
+        stats_table stats( _self, scope_of(_self) );
+        auto st = stats.get_or_default( token_stats{} );
+        uint8_t kind = kind_of( quantity.symbol );
+        eosio_assert( kind < st.kinds.size() && st.kinds[kind].issuer != account_type(), "token with symbol does not exist. create token before issue" );
+
+        st.kinds[kind].supply += quantity;
+        stats.set( st, _self );
     }
 
-EOSIO_ABI( devtooth_nft, (create)(issue)(transferid)(changestate)(backtogame)(clean) )
+DEVTOOTH_DISPATCH_TRANSFER( devtooth_nft, (create)(issue)(transferid)(transferk)(changestate)(changestatek)(backtogame)(backtogamek)(clean)(sethistory)(lend)(lock)(reclaim)(equip)(unequip)(migrate)(logevent)(setshard)(setstats)(syncstats)(auction)(bid)(claim)(sweep)(withdraw)(exportrows)(importrows)(merklefill)(merkleproof)(gctemplate)(gctokens)(purge)(ramreport), ontransfer )
 
 } /// namespace eosio
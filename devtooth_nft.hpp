@@ -1,34 +1,188 @@
 #pragma once
 
-#include <eosiolib/eosio.hpp>
-#include <eosiolib/asset.hpp>
-#include <string>
+#include "devtooth_compat.hpp"
 
 namespace eosio {
     using std::string;
     typedef uint64_t id_type;
 
-    class devtooth_nft : public contract {
+    CONTRACT devtooth_nft : public contract {
     public:
-        devtooth_nft(account_name self) : contract(self), s_tokens(_self, _self), m_tokens(_self, _self), i_tokens(_self, _self) {}
+#ifdef DEVTOOTH_EOSIO_CDT
+        devtooth_nft(name self, name code, datastream<const char*> ds) : contract(self, code, ds), s_tokens(_self, _self.value), m_tokens(_self, _self.value), i_tokens(_self, _self.value) {}
+#else
+        devtooth_nft(account_type self) : contract(self), s_tokens(_self, _self), m_tokens(_self, _self), i_tokens(_self, _self) {}
+#endif
 
         // @abi action
-        void create(account_name issuer, string symbol);
+        ACTION create(account_type issuer, string symbol);
 
         // @abi action
-        void issue(account_name to, asset quantity, uint64_t index);
+        ACTION issue(account_type to, asset quantity, uint64_t index);
 
         // @abi action
-        void transferid(account_name from, account_name to, id_type id, string sym);
+        ACTION transferid(account_type from, account_type to, id_type id, string sym);
 
         // @abi action
-        void changestate(account_name from, string sym, id_type id);
+        ACTION transferk(account_type from, account_type to, id_type id, uint8_t kind);
 
-        // @abi action 
-        void backtogame(account_name from, string sym, id_type id);
+        // @abi action
+        ACTION changestate(account_type from, string sym, id_type id);
+
+        // @abi action
+        ACTION changestatek(account_type from, uint8_t kind, id_type id);
+
+        // @abi action
+        ACTION backtogame(account_type from, string sym, id_type id);
+
+        // @abi action
+        ACTION backtogamek(account_type from, uint8_t kind, id_type id);
+
+        // @abi action
+        ACTION clean();
+
+        // @abi action
+        ACTION sethistory(uint8_t depth);
+
+        // @abi action
+        ACTION lend(account_type owner, account_type lessee, uint8_t kind, id_type id, uint32_t duration);
+
+        // @abi action
+        ACTION lock(account_type owner, uint8_t kind, id_type id, uint32_t duration);
+
+        // @abi action
+        ACTION reclaim(uint32_t max_count);
+
+        // @abi action
+        ACTION equip(account_type owner, id_type servant_id, std::vector<id_type> item_ids);
+
+        // @abi action
+        ACTION unequip(account_type owner, id_type servant_id);
+
+        // @abi action
+        ACTION migrate(account_type owner, uint8_t kind, uint64_t cursor, uint32_t budget);
+
+        // @abi action
+        ACTION setshard(uint8_t index, uint8_t count, uint8_t kind_mask, bool by_owner);
+
+        struct status_info;
+
+        // @abi action
+        ACTION setstats(uint8_t kind, id_type id, status_info status, uint32_t atk, uint32_t def);
+
+        struct stat_delta;
+
+        // @abi action
+        ACTION syncstats(std::vector<stat_delta> deltas);
 
         // @abi action
-        void clean();
+        ACTION auction(account_type seller, uint8_t kind, id_type id, uint8_t type, asset start_price, asset end_price, uint32_t duration);
+
+        // @abi action
+        ACTION bid(account_type bidder, id_type id, asset amount);
+
+        // @abi action
+        ACTION claim(id_type id);
+
+        // @abi action
+        ACTION sweep(uint32_t max_count);
+
+        // @abi action
+        ACTION withdraw(account_type owner, asset quantity);
+
+        // eosio.token transfer 알림, 경매 입찰용 예치금 적립 (action 으로 노출하지 않음)
+        void ontransfer(account_type from, account_type to, asset quantity, string memo);
+
+        // @abi action
+        ACTION exportrows(uint8_t table, uint32_t budget, bool restart);
+
+        // @abi action
+        ACTION importrows(uint8_t table, std::vector<char> rows);
+
+        // @abi action
+        ACTION merklefill(uint8_t kind, uint64_t cursor, uint32_t budget);
+
+        // @abi action
+        ACTION merkleproof(uint8_t kind, id_type id);
+
+        // @abi action
+        ACTION gctemplate(uint32_t max_count);
+
+        // @abi action
+        ACTION gctokens(uint8_t kind, uint64_t cursor, uint32_t budget);
+
+        // @abi action
+        ACTION purge(uint8_t kind, uint32_t budget);
+
+        // @abi action
+        ACTION ramreport(uint32_t users, uint32_t servants, uint32_t monsters, uint32_t items);
+
+        // @abi action
+        ACTION logevent(uint8_t version, uint8_t type, uint8_t kind, account_type from, account_type to, std::vector<id_type> ids, asset quantity);
+
+        // 토큰 종류, string 심볼 대신 action 인자로 사용 (UTS, UTM, UTI)
+        enum token_kind : uint8_t {
+            servant_kind = 0,
+            monster_kind = 1,
+            item_kind = 2,
+            kind_count
+        };
+
+        // logevent 로 보내는 이벤트 종류, 필드가 바뀌면 event_version 을 올림
+        static const uint8_t event_version = 2;  // 2 : quantity 추가
+        enum event_type : uint8_t {
+            event_issue = 0,    // _self -> to, 새로 발급된 토큰
+            event_transfer,     // from -> to
+            event_list,         // idle -> selling
+            event_unlist,       // selling -> idle
+            event_burn,         // backtogame, from -> _self
+            event_lend,         // owner -> lessee, rented
+            event_lock,         // owner, locked
+            event_release,      // 대여/잠금 만료, idle 로 복귀
+            event_equip,        // ids = 서번트, 슬롯별 아이템
+            event_stats,        // setstats / syncstats 로 능력치 갱신
+            event_auction,      // idle -> auction
+            event_settle,       // 경매 종료, 판매자 -> 낙찰자 (유찰이면 판매자), quantity = 낙찰가
+            event_bid,          // 입찰, 입찰자 -> 판매자, quantity = 입찰액
+            event_deposit,      // 예치금 적립, 계정 -> _self, kind 0 / ids 없음
+            event_withdraw      // 예치금 출금, _self -> 계정, kind 0 / ids 없음
+        };
+
+        enum auction_type : uint8_t {
+            english_auction = 0,   // 오름 경매, 종료 시 최고 입찰자 낙찰
+            dutch_auction = 1      // 내림 경매, 현재가 이상 첫 입찰에 낙찰
+        };
+
+        // exportrows / importrows 대상 테이블, 토큰 테이블은 token_kind 와 같은 번호
+        enum migrate_table : uint8_t {
+            migrate_servant = 0,    // utstokens
+            migrate_monster = 1,    // utmtokens
+            migrate_item = 2,       // utitokens
+            migrate_template = 3,   // templates
+            migrate_table_count
+        };
+
+        static const uint8_t servant_slot_count = 3;  // 서번트 장비 슬롯 개수
+
+        // 토큰 아이디 상위 8 bit 는 샤드 번호, 하위 56 bit 는 샤드 안에서의 순번
+        static const uint8_t shard_id_shift = 56;
+        static const uint64_t local_id_mask = (uint64_t(1) << shard_id_shift) - 1;
+
+        // RAM 사용량 계산용 nodeos billable_size 상수 (행 데이터 크기는 별도)
+        static const uint64_t row_overhead = 108;       // key_value_object
+        static const uint64_t index64_overhead = 128;   // index64_object, 보조 인덱스 행
+        static const uint64_t index128_overhead = 136;  // index128_object
+        static const uint64_t table_overhead = 108;     // table_id_object, (code, scope, table) 마다 하나
+
+        // (kind, id) 머클 잎 조회 키
+        static uint128_t token_key(uint8_t kind, id_type id) {
+            return (uint128_t(kind) << 64) | id;
+        }
+
+        // (master, t_idx) composite key : 유저 테이블 행 하나당 토큰 하나
+        static uint128_t master_key(account_type master, uint64_t t_idx) {
+            return (uint128_t(scope_of(master)) << 64) | t_idx;
+        }
 
         // servant struct
         struct status_info
@@ -41,6 +195,26 @@ namespace eosio {
             uint32_t plus_int = 0;
         };
 
+        // 마켓 필터용 능력치 캐시 : 기본 + 추가 합계, 아이템 공격/방어
+        struct combat_stats
+        {
+            uint32_t total_str = 0;
+            uint32_t total_dex = 0;
+            uint32_t total_int = 0;
+            uint32_t atk = 0;
+            uint32_t def = 0;
+
+            uint64_t power() const { return uint64_t(total_str) + total_dex + total_int + atk + def; }
+        };
+
+        // syncstats 항목 : packed = exp << 32 | upgrade << 16 | grade
+        struct stat_delta
+        {
+            uint8_t kind;
+            id_type id;
+            uint64_t packed;
+        };
+
         struct servant_info
         {
             uint32_t id;
@@ -78,70 +252,247 @@ namespace eosio {
             status_info status; //기본 힘,민,지 추가 힘,민,지
         };
 
-	    // @abi table accounts i64
-        struct account {
+        // @abi table accounts i64
+        TABLE account {
 
             asset balance;
 
-            uint64_t primary_key() const { return balance.symbol.name(); }
+            uint64_t primary_key() const { return sym_code(balance.symbol); }
         };
 
-        // @abi table stat i64
-        struct stats {
+        struct kind_stats {
             asset supply;
-            account_name issuer;
+            account_type issuer = account_type();
+        };
 
-            uint64_t primary_key() const { return supply.symbol.name(); }
-            account_name get_issuer() const { return issuer; }
+        // 종류별 supply / issuer, token_kind 순서의 고정 크기 배열
+        // @abi table tokenstats i64
+        TABLE token_stats {
+            std::vector<kind_stats> kinds;
         };
 
-        // @abi table utstokens i64
-        class utstoken {
-            public: 
-                id_type idx;          // Unique 64 bit identifier,
-                uint32_t t_idx;       // 유저 테이블 상에서의 고유 인덱스
-                string state;         // 토큰 상태 
-    
-                account_name owner;  // token owner
-                account_name master; // token master for search detail info
-                asset value;         // token value (1 UTS)
+        // @abi table globalid i64
+        TABLE global_id {
+            id_type next_id = 1;  // 다음에 발급할 토큰 아이디, 0 은 발급하지 않음
+        };
+
+        // 샤드 배포 설정 : 이 계정이 맡는 토큰 종류 (kind_mask bit) 와 owner 해시 분할
+        // @abi table shard i64
+        TABLE shard_info {
+            uint8_t index = 0;
+            uint8_t count = 1;
+            uint8_t kind_mask = 0x7;
+            bool by_owner = false;     // true 면 content_key(pack(owner)) % count == index 인 owner 만 발급 (이름 sha256 앞 8 byte)
+        };
 
-                id_type primary_key() const { return idx; }
-                account_name get_owner() const { return owner; }
+        // @abi table config i64
+        TABLE config_info {
+            uint8_t history_depth = 0;  // 토큰별 소유자 기록 개수, 0 이면 기록하지 않음
         };
 
-         // @abi table utmtokens i64
-        class utmtoken {
-            public: 
-                id_type idx;          // Unique 64 bit identifier,
-                uint32_t t_idx;       // 유저 테이블 상에서의 고유 인덱스
-                string state;         // 토큰 상태 
+        struct owner_record {
+            account_type owner = account_type();
+            uint32_t time = 0;
+        };
 
-                account_name owner;  // token owner
-                account_name master; // token master for search detail info
-                asset value;         // token value (1 UTM)
+        // @abi table history i64
+        TABLE token_history {
+            id_type idx;                         // 토큰 아이디
+            uint8_t head = 0;                    // 다음에 덮어쓸 위치
+            std::vector<owner_record> records;   // 최근 소유자 (history_depth 크기 고정)
 
-                id_type primary_key() const { return idx; }
-                account_name get_owner() const { return owner; }
+            id_type primary_key() const { return idx; }
         };
 
-         // @abi table utitokens i64
-        class utitoken {
-            public: 
-                id_type idx;          // Unique 64 bit identifier,
-                uint32_t t_idx;       // 유저 테이블 상에서의 고유 인덱스
-                string state;         // 토큰 상태 
+        // 여러 토큰이 공유하는 고정 속성, 아이템 외에는 쓰지 않는 필드는 0
+        struct template_attrs {
+            uint8_t kind;       // 토큰 종류 (token_kind)
+            uint32_t id;        // 리소스 아이디
+            uint32_t type = 0;
+            uint32_t tier = 0;
+            uint32_t job = 0;
+            uint32_t grade = 0;
+        };
+
+        // 고정 속성 템플릿, template_id = sha256(pack(attrs)) 앞 8 byte
+        // @abi table templates i64
+        TABLE token_template {
+            uint64_t template_id;
+            template_attrs attrs;
+            uint64_t refcount = 0;   // 이 템플릿을 참조하는 토큰 개수, 0 이면 gctemplate 대상
+
+            uint64_t primary_key() const { return template_id; }
+            uint64_t get_refcount() const { return refcount; }
+        };
 
-                account_name owner;  // token owner
-                account_name master; // token master for search detail info
-                asset value;         // token value (1 UTI)
+        // 경매 중인 토큰, 종료 후 bid / claim / sweep 에서 정산
+        // @abi table auctions i64
+        TABLE auction_info {
+            id_type idx;            // 토큰 아이디
+            uint8_t kind;           // 토큰 종류 (token_kind)
+            uint8_t type;           // auction_type
+            account_type seller;
+            account_type bidder = account_type();   // 최고 입찰자, 없으면 비어 있음
+            asset start_price;      // english : 최저 입찰가, dutch : 시작가
+            asset end_price;        // dutch : 종료 시각의 가격
+            asset high_bid;         // english : 현재 최고 입찰가
+            uint32_t start;
+            uint32_t end;
+
+            id_type primary_key() const { return idx; }
+            uint64_t get_end() const { return end; }
+            uint64_t get_high_bid() const { return high_bid.amount; }
+        };
+
+        // 입찰용 예치금 / 환불금, eosio.token 으로 입금하고 withdraw 로 출금
+        // @abi table funds i64
+        TABLE fund {
+            account_type owner;
+            asset balance;
+
+            uint64_t primary_key() const { return scope_of(owner); }
+        };
+
+        // 계정 이전용 export / import 진행 상황, scope 는 N(export) / N(import)
+        // @abi table migrations i64
+        TABLE migration_state {
+            uint8_t table;            // migrate_table
+            uint64_t cursor = 0;      // 다음 export 를 시작할 primary key
+            uint64_t count = 0;       // 지금까지 처리한 행 수
+            uint64_t checksum = 0;    // 행 순서대로 누적한 content_key, export / import 결과가 같아야 함
+
+            uint64_t primary_key() const { return table; }
+        };
+
+        // sha256 32 byte 를 앞 16 byte (high) / 뒤 16 byte (low) 로 저장, 0 은 빈 서브트리
+        struct node_hash {
+            uint128_t high = 0;
+            uint128_t low = 0;
+
+            bool empty() const { return high == 0 && low == 0; }
+            bool operator==( const node_hash& other ) const { return high == other.high && low == other.low; }
+        };
+
+        // 소유 상태 머클 트리의 잎, 토큰 하나당 하나이고 slot 은 0 부터 빈틈 없이 채움
+        // @abi table mleaves i64
+        TABLE merkle_leaf {
+            uint64_t slot;
+            uint8_t kind;       // 토큰 종류 (token_kind)
+            id_type id;         // 토큰 아이디
+            node_hash hash;     // sha256(pack(kind, id, owner, state))
+
+            uint64_t primary_key() const { return slot; }
+            uint128_t get_token() const { return token_key(kind, id); }
+        };
+
+        // 머클 내부 노드, scope 는 잎에서부터의 높이 (1 ~ height), 빈 서브트리는 행을 두지 않음
+        // @abi table mnodes i64
+        TABLE merkle_node {
+            uint64_t index;     // 같은 높이에서의 위치
+            node_hash hash;     // sha256(left || right)
+
+            uint64_t primary_key() const { return index; }
+        };
+
+        // @abi table merkle i64
+        TABLE merkle_info {
+            node_hash root;
+            uint8_t height = 0;        // leaf_count <= 2^height
+            uint64_t leaf_count = 0;
+        };
+
+        struct inventory_entry {
+            uint8_t kind;     // 토큰 종류 (token_kind)
+            id_type id;       // 토큰 아이디
+
+            bool operator<( const inventory_entry& other ) const {
+                return kind != other.kind ? kind < other.kind : id < other.id;
+            }
+        };
+
+        // 유저별 보유 토큰 목록, 한 번의 행 조회로 전체 인벤토리를 읽기 위한 캐시
+        // @abi table inventory i64
+        TABLE inventory {
+            account_type owner;
+            std::vector<inventory_entry> entries;  // (kind, id) 오름차순
+
+            uint64_t primary_key() const { return scope_of(owner); }
+        };
+
+        // 대여(rented) / 잠금(locked) 상태 토큰, 만료 시 idle 로 복귀
+        // @abi table leases i64
+        TABLE lease {
+            id_type idx;            // 토큰 아이디
+            uint8_t kind;           // 토큰 종류 (token_kind)
+            account_type owner;     // 토큰 소유자
+            account_type lessee;    // 대여받은 계정, 잠금이면 owner
+            uint32_t expiry;        // 만료 시각 (초)
+
+            id_type primary_key() const { return idx; }
+            uint64_t get_expiry() const { return expiry; }
+        };
+
+        // @abi table utstokens i64
+        TABLE utstoken {
+            id_type idx;          // Unique 64 bit identifier,
+            uint32_t t_idx;       // 유저 테이블 상에서의 고유 인덱스
+            string state;         // 토큰 상태
+
+            account_type owner;  // token owner
+            account_type master; // token master for search detail info
+            asset value;         // token value (1 UTS)
+            combat_stats stats;  // 게임에서 갱신한 능력치
+            uint64_t growth = 0; // 성장 수치 (stat_delta::packed)
+            uint64_t template_id = 0;  // 고정 속성 템플릿 (templates), 0 이면 없음
+            std::vector<id_type> equip_slot;  // 슬롯별 장착 아이템 토큰 아이디, 0 은 빈 슬롯
+
+            id_type primary_key() const { return idx; }
+            uint64_t get_owner() const { return scope_of(owner); }
+            uint128_t get_master_index() const { return master_key(master, t_idx); }
+            uint64_t get_power() const { return stats.power(); }
+            bool has_equipment() const { return !equip_slot.empty(); }
+        };
+
+        // @abi table utmtokens i64
+        TABLE utmtoken {
+            id_type idx;          // Unique 64 bit identifier,
+            uint32_t t_idx;       // 유저 테이블 상에서의 고유 인덱스
+            string state;         // 토큰 상태
+
+            account_type owner;  // token owner
+            account_type master; // token master for search detail info
+            asset value;         // token value (1 UTM)
+            combat_stats stats;  // 게임에서 갱신한 능력치
+            uint64_t growth = 0; // 성장 수치 (stat_delta::packed)
+            uint64_t template_id = 0;  // 고정 속성 템플릿 (templates), 0 이면 없음
+
+            id_type primary_key() const { return idx; }
+            uint64_t get_owner() const { return scope_of(owner); }
+            uint128_t get_master_index() const { return master_key(master, t_idx); }
+            uint64_t get_power() const { return stats.power(); }
+        };
 
-                id_type primary_key() const { return idx; }
-                account_name get_owner() const { return owner; }
+        // @abi table utitokens i64
+        TABLE utitoken {
+            id_type idx;          // Unique 64 bit identifier,
+            uint32_t t_idx;       // 유저 테이블 상에서의 고유 인덱스
+            string state;         // 토큰 상태
+
+            account_type owner;  // token owner
+            account_type master; // token master for search detail info
+            asset value;         // token value (1 UTI)
+            combat_stats stats;  // 게임에서 갱신한 능력치
+            uint64_t growth = 0; // 성장 수치 (stat_delta::packed)
+            uint64_t template_id = 0;  // 고정 속성 템플릿 (templates), 0 이면 없음
+
+            id_type primary_key() const { return idx; }
+            uint64_t get_owner() const { return scope_of(owner); }
+            uint128_t get_master_index() const { return master_key(master, t_idx); }
+            uint64_t get_power() const { return stats.power(); }
         };
 
         // @abi table preservant i64
-        struct tservant {
+        TABLE tservant {
             uint64_t index;
             uint32_t id;
             status_info status;
@@ -150,7 +501,7 @@ namespace eosio {
         };
 
         // @abi table premonster i64
-        struct tmonster {
+        TABLE tmonster {
             uint64_t index;
             uint32_t id;
             uint32_t grade;
@@ -160,7 +511,7 @@ namespace eosio {
         };
 
         // @abi table preitem i64
-        struct titem {
+        TABLE titem {
             uint64_t index;
             uint32_t id;
             uint32_t type;
@@ -172,30 +523,111 @@ namespace eosio {
             uint64_t primary_key() const { return index; }
         };
 
-	    using account_index = eosio::multi_index<N(accounts), account>;
+        using account_index = eosio::multi_index<N(accounts), account>;
 
-	    using currency_index = eosio::multi_index<N(stat), stats,
-	                       indexed_by< N( byissuer ), const_mem_fun< stats, account_name, &stats::get_issuer> > >;
+        using stats_table = eosio::singleton<N(tokenstats), token_stats>;
 
-	    using servant_index = eosio::multi_index<N(utstokens), utstoken,
-	                    indexed_by< N( byowner ), const_mem_fun< utstoken, account_name, &utstoken::get_owner> >>;
+        using servant_index = eosio::multi_index<N(utstokens), utstoken,
+                        indexed_by< N( byowner ), const_mem_fun< utstoken, uint64_t, &utstoken::get_owner> >,
+                        indexed_by< N( bymaster ), const_mem_fun< utstoken, uint128_t, &utstoken::get_master_index> >,
+                        indexed_by< N( bypower ), const_mem_fun< utstoken, uint64_t, &utstoken::get_power> > >;
 
         using monster_index = eosio::multi_index<N(utmtokens), utmtoken,
-	                    indexed_by< N( byowner ), const_mem_fun< utmtoken, account_name, &utmtoken::get_owner> >>;
+                        indexed_by< N( byowner ), const_mem_fun< utmtoken, uint64_t, &utmtoken::get_owner> >,
+                        indexed_by< N( bymaster ), const_mem_fun< utmtoken, uint128_t, &utmtoken::get_master_index> >,
+                        indexed_by< N( bypower ), const_mem_fun< utmtoken, uint64_t, &utmtoken::get_power> > >;
 
         using item_index = eosio::multi_index<N(utitokens), utitoken,
-	                    indexed_by< N( byowner ), const_mem_fun< utitoken, account_name, &utitoken::get_owner> >>;
+                        indexed_by< N( byowner ), const_mem_fun< utitoken, uint64_t, &utitoken::get_owner> >,
+                        indexed_by< N( bymaster ), const_mem_fun< utitoken, uint128_t, &utitoken::get_master_index> >,
+                        indexed_by< N( bypower ), const_mem_fun< utitoken, uint64_t, &utitoken::get_power> > >;
+
+        using global_id_table = eosio::singleton<N(globalid), global_id>;
+        using config_table = eosio::singleton<N(config), config_info>;
+        using shard_table = eosio::singleton<N(shard), shard_info>;
+        using history_index = eosio::multi_index<N(history), token_history>;
+        using inventory_index = eosio::multi_index<N(inventory), inventory>;
+        using auction_index = eosio::multi_index<N(auctions), auction_info,
+                        indexed_by< N( byend ), const_mem_fun< auction_info, uint64_t, &auction_info::get_end> >,
+                        indexed_by< N( byhighbid ), const_mem_fun< auction_info, uint64_t, &auction_info::get_high_bid> > >;
+        using fund_index = eosio::multi_index<N(funds), fund>;
+        using migration_index = eosio::multi_index<N(migrations), migration_state>;
+        using merkle_leaf_index = eosio::multi_index<N(mleaves), merkle_leaf,
+                        indexed_by< N( bytoken ), const_mem_fun< merkle_leaf, uint128_t, &merkle_leaf::get_token> > >;
+        using merkle_node_index = eosio::multi_index<N(mnodes), merkle_node>;
+        using merkle_table = eosio::singleton<N(merkle), merkle_info>;
+        using template_index = eosio::multi_index<N(templates), token_template,
+                        indexed_by< N( byrefcount ), const_mem_fun< token_template, uint64_t, &token_template::get_refcount> > >;
+        using lease_index = eosio::multi_index<N(leases), lease,
+                        indexed_by< N( byexpiry ), const_mem_fun< lease, uint64_t, &lease::get_expiry> > >;
 
         using servant_table = eosio::multi_index<N(preservant), tservant>;
         using monster_table = eosio::multi_index<N(premonster), tmonster>;
         using item_table = eosio::multi_index<N(preitem), titem>;
 
-	    servant_index s_tokens;
+        servant_index s_tokens;
         monster_index m_tokens;
         item_index i_tokens;
 
-        void sub_balance(account_name owner, asset value);
-        void add_balance(account_name owner, asset value, account_name ram_payer);
+        template<typename TokenIndex, typename PreTable>
+        void migrate_scope(TokenIndex& tokens, const PreTable& rows, account_type owner, sym_type symbols, uint64_t cursor, uint32_t budget);
+
+        template<typename T>
+        static uint64_t row_ram(const T& row, uint8_t index64_count, uint8_t index128_count);
+
+        template<typename Index>
+        void export_rows(const Index& rows, uint8_t table, uint32_t budget, bool restart);
+
+        template<typename Row, typename Index, typename Fn>
+        void import_rows(Index& rows, uint8_t table, const std::vector<char>& data, Fn&& on_row);
+
+        template<typename PreTable, typename TokenIndex>
+        void collect_orphans(TokenIndex& tokens, uint8_t kind, uint64_t cursor, uint32_t budget);
+
+        bool purge_tokens(uint8_t kind, uint32_t budget, bool keep_tree);
+
+        static bool holds_items(const utstoken& token) { return token.has_equipment(); }
+        template<typename T>
+        static bool holds_items(const T&) { return false; }
+
+        static uint64_t chain_checksum(uint64_t checksum, const std::vector<char>& row);
+
+        static node_hash digest_of(const std::vector<char>& data);
+        static node_hash combine(const node_hash& left, const node_hash& right);
+        static std::vector<char> bytes_of(const node_hash& h);
+        node_hash merkle_node_at(uint8_t level, uint64_t index);
+        void set_merkle_node(uint8_t level, uint64_t index, const node_hash& hash);
+        void merkle_path(merkle_info& m, uint64_t slot);
+        void merkle_update(uint8_t kind, id_type id);
+
+        void emit_event(uint8_t type, uint8_t kind, account_type from, account_type to, const std::vector<id_type>& ids, asset quantity = asset());
+        static uint8_t kind_of(sym_type symbols);
+        static combat_stats make_stats(const status_info& status, uint32_t atk = 0, uint32_t def = 0);
+        static combat_stats stats_of(const tservant& row) { return make_stats(row.status); }
+        static combat_stats stats_of(const tmonster& row) { return make_stats(row.status); }
+        static combat_stats stats_of(const titem&) { return combat_stats{}; }
+        static template_attrs attrs_of(const tservant& row) { return template_attrs{ servant_kind, row.id }; }
+        static template_attrs attrs_of(const tmonster& row) { return template_attrs{ monster_kind, row.id, 0, 0, 0, row.grade }; }
+        static template_attrs attrs_of(const titem& row) { return template_attrs{ item_kind, row.id, row.type, row.tier, row.job, row.grade }; }
+        uint64_t acquire_template(const template_attrs& attrs, account_type ram_payer);
+        void release_template(uint64_t template_id);
+        void check_shard(uint8_t kind, account_type owner);
+        global_id load_ids(global_id_table& global_ids);
+        id_type reserve_ids(uint64_t count);
+        void record_owner(id_type id, account_type owner, account_type ram_payer);
+        void resize_history(token_history& h, uint8_t depth);
+        void erase_history(id_type id);
+        void start_lease(account_type owner, account_type lessee, uint8_t kind, id_type id, uint32_t duration, string state);
+        void expire_lease(id_type id);
+        void restore_token(const lease& l);
+        static asset current_price(const auction_info& a);
+        void settle_auction(const auction_info& a);
+        void add_fund(account_type owner, asset quantity);
+        void sub_fund(account_type owner, asset quantity);
+        void add_inventory(account_type owner, uint8_t kind, const std::vector<id_type>& ids);
+        void sub_inventory(account_type owner, uint8_t kind, id_type id);
+        void sub_balance(account_type owner, asset value);
+        void add_balance(account_type owner, asset value, account_type ram_payer);
         void sub_supply(asset quantity);
         void add_supply(asset quantity);
     };
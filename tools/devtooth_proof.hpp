@@ -0,0 +1,230 @@
+#pragma once
+
+// 컨트랙트 밖 (인덱서, 클라이언트) 에서 소유 상태 머클 트리의 포함 증명을 만들고 검증하는 native 라이브러리
+//
+//   잎      : sha256(pack(kind, id, owner, state))           컨트랙트 merkle_update 와 같은 직렬화
+//   노드    : sha256(left || right), 둘 다 빈 서브트리면 빈 값  컨트랙트 combine 과 같은 규칙
+//   높이    : merkle 테이블의 height, slot 은 mleaves 의 slot
+//
+// merkleproof(kind, id) action 이 출력하는 slot / root / path 를 그대로 verify 에 넘기면 된다.
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace devtooth_proof {
+
+    typedef std::array<uint8_t, 32> hash256;
+
+    namespace detail {
+        inline uint32_t rotr( uint32_t x, int n ) { return (x >> n) | (x << (32 - n)); }
+
+        inline void sha256_block( uint32_t state[8], const uint8_t block[64] )
+        {
+            static const uint32_t k[64] = {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+            };
+
+            uint32_t w[64];
+            for( int i = 0; i < 16; ++i ) {
+                w[i] = uint32_t(block[4 * i]) << 24 | uint32_t(block[4 * i + 1]) << 16 | uint32_t(block[4 * i + 2]) << 8 | uint32_t(block[4 * i + 3]);
+            }
+            for( int i = 16; i < 64; ++i ) {
+                uint32_t s0 = rotr( w[i - 15], 7 ) ^ rotr( w[i - 15], 18 ) ^ (w[i - 15] >> 3);
+                uint32_t s1 = rotr( w[i - 2], 17 ) ^ rotr( w[i - 2], 19 ) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+            for( int i = 0; i < 64; ++i ) {
+                uint32_t t1 = h + (rotr( e, 6 ) ^ rotr( e, 11 ) ^ rotr( e, 25 )) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+                uint32_t t2 = (rotr( a, 2 ) ^ rotr( a, 13 ) ^ rotr( a, 22 )) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g; g = f; f = e; e = d + t1;
+                d = c; c = b; b = a; a = t1 + t2;
+            }
+            state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+            state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        }
+    }
+
+    inline hash256 sha256( const uint8_t* data, size_t size )
+    {
+        uint32_t state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+        size_t offset = 0;
+        for( ; offset + 64 <= size; offset += 64 ) {
+            detail::sha256_block( state, data + offset );
+        }
+
+        // 남은 바이트 + 0x80 + 0 채움 + 비트 길이 (big endian 64 bit)
+        uint8_t tail[128] = {};
+        size_t rest = size - offset;
+        if( rest > 0 ) {
+            std::memcpy( tail, data + offset, rest );
+        }
+        tail[rest] = 0x80;
+        size_t tail_size = rest + 9 <= 64 ? 64 : 128;
+        uint64_t bits = uint64_t(size) * 8;
+        for( int i = 0; i < 8; ++i ) {
+            tail[tail_size - 1 - i] = uint8_t( bits >> (8 * i) );
+        }
+        for( size_t i = 0; i < tail_size; i += 64 ) {
+            detail::sha256_block( state, tail + i );
+        }
+
+        hash256 out;
+        for( int i = 0; i < 8; ++i ) {
+            out[4 * i] = uint8_t( state[i] >> 24 );
+            out[4 * i + 1] = uint8_t( state[i] >> 16 );
+            out[4 * i + 2] = uint8_t( state[i] >> 8 );
+            out[4 * i + 3] = uint8_t( state[i] );
+        }
+        return out;
+    }
+
+    inline hash256 sha256( const std::vector<uint8_t>& data ) { return sha256( data.data(), data.size() ); }
+
+    inline bool is_empty( const hash256& h )
+    {
+        for( auto b : h ) {
+            if( b != 0 ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // pack(std::make_tuple(kind, id, owner, state)) : uint8, uint64 (little endian), 계정 이름 uint64, varuint32 길이 + 문자열
+    inline std::vector<uint8_t> pack_leaf( uint8_t kind, uint64_t id, uint64_t owner, const std::string& state )
+    {
+        std::vector<uint8_t> data;
+        data.push_back( kind );
+        for( int i = 0; i < 8; ++i ) {
+            data.push_back( uint8_t( id >> (8 * i) ) );
+        }
+        for( int i = 0; i < 8; ++i ) {
+            data.push_back( uint8_t( owner >> (8 * i) ) );
+        }
+        uint32_t len = uint32_t( state.size() );
+        do {
+            uint8_t b = len & 0x7f;
+            len >>= 7;
+            data.push_back( uint8_t( b | (len > 0 ? 0x80 : 0) ) );
+        } while( len > 0 );
+        data.insert( data.end(), state.begin(), state.end() );
+        return data;
+    }
+
+    inline hash256 leaf_hash( uint8_t kind, uint64_t id, uint64_t owner, const std::string& state )
+    {
+        return sha256( pack_leaf( kind, id, owner, state ) );
+    }
+
+    // 빈 서브트리 둘의 부모도 빈 서브트리
+    inline hash256 combine( const hash256& left, const hash256& right )
+    {
+        if( is_empty( left ) && is_empty( right ) ) {
+            return hash256{};
+        }
+        uint8_t data[64];
+        std::memcpy( data, left.data(), 32 );
+        std::memcpy( data + 32, right.data(), 32 );
+        return sha256( data, 64 );
+    }
+
+    // slot 순서의 잎 전체로 root 계산, leaves.size() <= 2^height
+    inline hash256 compute_root( std::vector<hash256> level, uint8_t height )
+    {
+        if( level.empty() ) {
+            return hash256{};
+        }
+        for( uint8_t h = 0; h < height; ++h ) {
+            std::vector<hash256> parent( (level.size() + 1) / 2 );
+            for( size_t i = 0; i < parent.size(); ++i ) {
+                parent[i] = combine( level[2 * i], 2 * i + 1 < level.size() ? level[2 * i + 1] : hash256{} );
+            }
+            level.swap( parent );
+        }
+        return level[0];
+    }
+
+    // slot 의 잎에서 root 까지의 형제 노드, 잎 쪽부터 height 개
+    inline std::vector<hash256> build_path( std::vector<hash256> level, uint8_t height, uint64_t slot )
+    {
+        std::vector<hash256> path;
+        for( uint8_t h = 0; h < height; ++h ) {
+            uint64_t sibling = slot ^ 1;
+            path.push_back( sibling < level.size() ? level[sibling] : hash256{} );
+
+            std::vector<hash256> parent( (level.size() + 1) / 2 );
+            for( size_t i = 0; i < parent.size(); ++i ) {
+                parent[i] = combine( level[2 * i], 2 * i + 1 < level.size() ? level[2 * i + 1] : hash256{} );
+            }
+            level.swap( parent );
+            slot >>= 1;
+        }
+        return path;
+    }
+
+    // 컨트랙트 merkle_path 와 같은 순서로 잎에서 root 를 다시 계산
+    inline hash256 root_from_path( hash256 leaf, uint64_t slot, const std::vector<hash256>& path )
+    {
+        for( const auto& sibling : path ) {
+            leaf = (slot & 1) ? combine( sibling, leaf ) : combine( leaf, sibling );
+            slot >>= 1;
+        }
+        return leaf;
+    }
+
+    inline bool verify( const hash256& leaf, uint64_t slot, const std::vector<hash256>& path, const hash256& root )
+    {
+        // path 가 height 보다 짧으면 slot 의 상위 bit 가 남음
+        if( path.size() < 64 && (slot >> path.size()) != 0 ) {
+            return false;
+        }
+        return root_from_path( leaf, slot, path ) == root;
+    }
+
+    inline std::string to_hex( const hash256& h )
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string out;
+        for( auto b : h ) {
+            out.push_back( digits[b >> 4] );
+            out.push_back( digits[b & 0xf] );
+        }
+        return out;
+    }
+
+    // merkleproof 가 출력한 64 자리 hex, 형식이 틀리면 false
+    inline bool from_hex( const std::string& hex, hash256& out )
+    {
+        if( hex.size() != 64 ) {
+            return false;
+        }
+        for( size_t i = 0; i < 32; ++i ) {
+            int v = 0;
+            for( int j = 0; j < 2; ++j ) {
+                char c = hex[2 * i + j];
+                int d = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+                if( d < 0 ) {
+                    return false;
+                }
+                v = v * 16 + d;
+            }
+            out[i] = uint8_t( v );
+        }
+        return true;
+    }
+
+} /// namespace devtooth_proof
@@ -0,0 +1,333 @@
+// devtooth_proof.hpp 검증 : make test
+//
+// 컨트랙트의 digest_of / combine / merkle_path / merkle_update 를 node_hash (uint128 high, low) 그대로 옮긴
+// 증분 트리를 돌리면서, 라이브러리로 만든 증명과 root 가 같은지 확인한다.
+
+#include "devtooth_proof.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <utility>
+
+using namespace devtooth_proof;
+
+static int failures = 0;
+
+#define CHECK( cond ) do { if( !(cond) ) { std::printf( "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond ); ++failures; } } while( 0 )
+
+namespace contract {
+    typedef unsigned __int128 uint128_t;
+
+    struct node_hash {
+        uint128_t high = 0;
+        uint128_t low = 0;
+
+        bool empty() const { return high == 0 && low == 0; }
+        bool operator==( const node_hash& other ) const { return high == other.high && low == other.low; }
+    };
+
+    node_hash digest_of( const std::vector<uint8_t>& data )
+    {
+        hash256 hash = sha256( data );
+
+        node_hash h;
+        for( int i = 0; i < 16; ++i ) {
+            h.high = (h.high << 8) | hash[i];
+            h.low = (h.low << 8) | hash[16 + i];
+        }
+        return h;
+    }
+
+    node_hash combine( const node_hash& left, const node_hash& right )
+    {
+        if( left.empty() && right.empty() ) {
+            return node_hash{};
+        }
+
+        std::vector<uint8_t> data( 64 );
+        for( int i = 0; i < 16; ++i ) {
+            data[15 - i] = uint8_t( left.high >> (8 * i) );
+            data[31 - i] = uint8_t( left.low >> (8 * i) );
+            data[47 - i] = uint8_t( right.high >> (8 * i) );
+            data[63 - i] = uint8_t( right.low >> (8 * i) );
+        }
+        return digest_of( data );
+    }
+
+    hash256 bytes_of( const node_hash& h )
+    {
+        hash256 out;
+        for( int i = 0; i < 16; ++i ) {
+            out[15 - i] = uint8_t( h.high >> (8 * i) );
+            out[31 - i] = uint8_t( h.low >> (8 * i) );
+        }
+        return out;
+    }
+
+    struct leaf {
+        uint8_t kind;
+        uint64_t id;
+        node_hash hash;
+    };
+
+    // mleaves / mnodes / merkle 싱글톤을 메모리로 옮긴 것
+    struct tree {
+        node_hash root;
+        uint8_t height = 0;
+        uint64_t leaf_count = 0;
+        std::map<uint64_t, leaf> leaves;
+        std::map<std::pair<uint8_t, uint64_t>, node_hash> nodes;
+
+        node_hash node_at( uint8_t level, uint64_t index ) const
+        {
+            if( level == 0 ) {
+                auto it = leaves.find( index );
+                return it == leaves.end() ? node_hash{} : it->second.hash;
+            }
+            auto it = nodes.find( std::make_pair( level, index ) );
+            return it == nodes.end() ? node_hash{} : it->second;
+        }
+
+        void set_node( uint8_t level, uint64_t index, const node_hash& hash )
+        {
+            if( hash.empty() ) {
+                nodes.erase( std::make_pair( level, index ) );
+            } else {
+                nodes[std::make_pair( level, index )] = hash;
+            }
+        }
+
+        void path( uint64_t slot )
+        {
+            node_hash h = node_at( 0, slot );
+            uint64_t index = slot;
+            for( uint8_t level = 0; level < height; ++level ) {
+                node_hash sibling = node_at( level, index ^ 1 );
+                h = (index & 1) ? combine( sibling, h ) : combine( h, sibling );
+                index >>= 1;
+                set_node( level + 1, index, h );
+            }
+            root = h;
+        }
+
+        bool find( uint8_t kind, uint64_t id, uint64_t& slot ) const
+        {
+            for( const auto& l : leaves ) {
+                if( l.second.kind == kind && l.second.id == id ) {
+                    slot = l.first;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // merkle_update, exists 면 잎을 넣거나 바꾸고 아니면 마지막 잎을 빈 자리로 옮김
+        void update( uint8_t kind, uint64_t id, bool exists, uint64_t owner, const std::string& state )
+        {
+            uint64_t slot;
+            bool found = find( kind, id, slot );
+
+            if( exists ) {
+                node_hash h = digest_of( pack_leaf( kind, id, owner, state ) );
+                if( !found ) {
+                    slot = leaf_count++;
+                    while( (slot >> height) != 0 ) {
+                        height += 1;
+                        root = combine( root, node_hash{} );
+                        set_node( height, 0, root );
+                    }
+                    leaves[slot] = leaf{ kind, id, h };
+                } else {
+                    if( leaves[slot].hash == h ) {
+                        return;
+                    }
+                    leaves[slot].hash = h;
+                }
+                path( slot );
+            } else if( found ) {
+                uint64_t last = leaf_count - 1;
+                if( slot != last ) {
+                    leaves[slot] = leaves[last];
+                    path( slot );
+                }
+                leaves.erase( last );
+                leaf_count = last;
+                path( last );
+            }
+        }
+
+        // merkleproof action 과 같이 저장된 노드에서 형제 노드를 읽음
+        std::vector<hash256> proof( uint64_t slot ) const
+        {
+            std::vector<hash256> siblings;
+            uint64_t index = slot;
+            for( uint8_t level = 0; level < height; ++level ) {
+                siblings.push_back( bytes_of( node_at( level, index ^ 1 ) ) );
+                index >>= 1;
+            }
+            return siblings;
+        }
+    };
+}
+
+static void test_sha256()
+{
+    CHECK( to_hex( sha256( std::vector<uint8_t>() ) ) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" );
+
+    std::string abc = "abc";
+    CHECK( to_hex( sha256( reinterpret_cast<const uint8_t*>( abc.data() ), abc.size() ) ) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" );
+
+    // 패딩이 두 블록으로 넘어가는 56 byte 입력
+    std::string two = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    CHECK( to_hex( sha256( reinterpret_cast<const uint8_t*>( two.data() ), two.size() ) ) == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" );
+
+    std::vector<uint8_t> million( 1000000, 'a' );
+    CHECK( to_hex( sha256( million ) ) == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" );
+}
+
+static void test_pack_leaf()
+{
+    std::vector<uint8_t> expected = {
+        2,
+        0x34, 0x12, 0, 0, 0, 0, 0, 0x01,
+        0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+        4, 'i', 'd', 'l', 'e'
+    };
+    CHECK( pack_leaf( 2, 0x0100000000001234ULL, 0x1122334455667788ULL, "idle" ) == expected );
+
+    // 128 byte 이상 문자열은 varuint32 길이가 2 byte
+    std::vector<uint8_t> data = pack_leaf( 0, 1, 1, std::string( 200, 'x' ) );
+    CHECK( data.size() == 17 + 2 + 200 );
+    CHECK( data[17] == 0xc8 && data[18] == 0x01 );
+}
+
+static void test_combine()
+{
+    contract::node_hash zero;
+    CHECK( contract::combine( zero, zero ).empty() );
+    CHECK( is_empty( combine( hash256{}, hash256{} ) ) );
+
+    // 컨트랙트의 node_hash 직렬화와 라이브러리의 32 byte 표현이 같은 해시를 만드는지
+    contract::node_hash a = contract::digest_of( pack_leaf( 0, 1, 100, "idle" ) );
+    contract::node_hash b = contract::digest_of( pack_leaf( 1, 2, 200, "selling" ) );
+    CHECK( contract::bytes_of( a ) == leaf_hash( 0, 1, 100, "idle" ) );
+    CHECK( contract::bytes_of( contract::combine( a, b ) ) == combine( contract::bytes_of( a ), contract::bytes_of( b ) ) );
+    CHECK( contract::bytes_of( contract::combine( a, zero ) ) == combine( contract::bytes_of( a ), hash256{} ) );
+    CHECK( contract::bytes_of( contract::combine( zero, b ) ) == combine( hash256{}, contract::bytes_of( b ) ) );
+}
+
+static void check_tree( const contract::tree& t, const std::map<std::pair<uint8_t, uint64_t>, std::pair<uint64_t, std::string>>& tokens )
+{
+    CHECK( t.leaf_count == tokens.size() );
+    CHECK( t.leaves.size() == t.leaf_count );
+
+    std::vector<hash256> leaves;
+    for( const auto& l : t.leaves ) {
+        CHECK( l.first == leaves.size() );
+        auto token = tokens.find( std::make_pair( l.second.kind, l.second.id ) );
+        CHECK( token != tokens.end() );
+        if( token == tokens.end() ) {
+            return;
+        }
+        leaves.push_back( leaf_hash( l.second.kind, l.second.id, token->second.first, token->second.second ) );
+        CHECK( contract::bytes_of( l.second.hash ) == leaves.back() );
+    }
+
+    hash256 root = contract::bytes_of( t.root );
+    CHECK( compute_root( leaves, t.height ) == root );
+
+    for( uint64_t slot = 0; slot < leaves.size(); ++slot ) {
+        std::vector<hash256> stored = t.proof( slot );
+        CHECK( stored == build_path( leaves, t.height, slot ) );
+        CHECK( verify( leaves[slot], slot, stored, root ) );
+
+        // 잎, slot, 형제 노드 중 하나라도 바뀌면 실패해야 함
+        hash256 forged = leaves[slot];
+        forged[31] ^= 1;
+        CHECK( !verify( forged, slot, stored, root ) );
+        if( leaves.size() > 1 ) {
+            CHECK( !verify( leaves[slot], slot ^ 1, stored, root ) );
+        }
+        if( !stored.empty() ) {
+            stored[0][0] ^= 0x80;
+            CHECK( !verify( leaves[slot], slot, stored, root ) );
+        }
+    }
+}
+
+static void test_incremental()
+{
+    static const char* states[] = { "idle", "selling", "rented", "locked", "equipped", "auction" };
+
+    contract::tree t;
+    std::map<std::pair<uint8_t, uint64_t>, std::pair<uint64_t, std::string>> tokens;
+    check_tree( t, tokens );
+
+    std::srand( 7 );
+    uint64_t next_id = 1;
+    for( int step = 0; step < 600; ++step ) {
+        int op = std::rand() % 10;
+        if( tokens.empty() || op < 4 ) {
+            // issue
+            uint8_t kind = uint8_t( std::rand() % 3 );
+            uint64_t id = next_id++;
+            uint64_t owner = 1000 + std::rand() % 5;
+            tokens[std::make_pair( kind, id )] = std::make_pair( owner, std::string( "idle" ) );
+            t.update( kind, id, true, owner, "idle" );
+        } else {
+            auto it = tokens.begin();
+            std::advance( it, std::rand() % tokens.size() );
+            uint8_t kind = it->first.first;
+            uint64_t id = it->first.second;
+            if( op < 8 ) {
+                // transfer / 상태 변경
+                it->second.first = 1000 + std::rand() % 5;
+                it->second.second = states[std::rand() % 6];
+                t.update( kind, id, true, it->second.first, it->second.second );
+            } else {
+                // burn
+                tokens.erase( it );
+                t.update( kind, id, false, 0, "" );
+            }
+        }
+        check_tree( t, tokens );
+    }
+
+    // 모두 지우면 빈 root, 높이는 줄지 않음
+    while( !tokens.empty() ) {
+        auto it = tokens.begin();
+        uint8_t kind = it->first.first;
+        uint64_t id = it->first.second;
+        tokens.erase( it );
+        t.update( kind, id, false, 0, "" );
+    }
+    check_tree( t, tokens );
+    CHECK( t.root.empty() );
+    CHECK( t.nodes.empty() );
+}
+
+static void test_hex()
+{
+    hash256 h = leaf_hash( 1, 42, 7, "idle" );
+    hash256 parsed;
+    CHECK( from_hex( to_hex( h ), parsed ) && parsed == h );
+    CHECK( !from_hex( "00", parsed ) );
+    CHECK( !from_hex( std::string( 64, 'g' ), parsed ) );
+}
+
+int main()
+{
+    test_sha256();
+    test_pack_leaf();
+    test_combine();
+    test_incremental();
+    test_hex();
+
+    if( failures > 0 ) {
+        std::printf( "%d check(s) failed\n", failures );
+        return 1;
+    }
+    std::printf( "all checks passed\n" );
+    return 0;
+}